@@ -0,0 +1,421 @@
+/*
+ * LED Light Show Benchmark
+ *
+ * Description: Measures what one frame costs, in timing cycles, for every
+ *              effect and for the two ways of putting a frame on the pins:
+ *              one gpio_pin_set_dt() call per LED (set_led()) and the
+ *              port-masked frame commit (led_frame_commit()). Every figure
+ *              is taken for 4 up to 1024 LEDs, 32 per emulated GPIO port
+ *              (boards/bench_ports.dtsi), so no two LEDs share a pin.
+ *              Effects are taken from the effect registry, so the
+ *              CONFIG_LED_SHOW_EFFECT_* options select what is measured;
+ *              the bytecode version of every effect (led_vm.h) is measured
+ *              too, as "vm:<effect>", and effects with a time function
+ *              are evaluated at scattered times, as "eval:<effect>".
+ *              Cross-fades are measured as the BAM planes of a plain
+ *              against a blended frame ("bam_frame", "bam_blend") and as
+ *              two effects stepped and blended per frame ("fade:<effect>",
+ *              the effect fading into the next one registered), next to
+ *              the same effect stepped alone into plain BAM planes
+ *              ("single:<effect>"); the difference is the fade's cost.
+ *
+ *              The blend kernels of the layer compositor (led_blend.h) are
+ *              measured on level buffers of up to 4096 LEDs, one row per
+ *              mode ("blend_<mode>", "blend_<mode>_50" at half opacity);
+ *              "layers" is the default overlay stack composited over a
+ *              frame. On a Cortex-M33 (mps2_an521) these are the DSP
+ *              kernels, elsewhere the SWAR fallback.
+ *
+ *              Results are printed as CSV lines starting with "BENCH,":
+ *              BENCH,<test>,<leds>,<cycles per frame>,<ns per frame>,
+ *              <LEDs per second, in millions>
+ *
+ * Platform:    native_sim, qemu_cortex_m3, mps2_an521
+ * RTOS:        Zephyr RTOS
+ * License:     MIT
+ */
+
+#include <stdio.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/timing/timing.h>
+
+#include "effects.h"
+#include "effects/effects_vm.h"
+#include "led_bam.h"
+#include "led_frame.h"
+#include "led_layer.h"
+
+/* ============================================================================
+ * CONFIGURATION
+ * ============================================================================
+ */
+#define BENCH_FRAMES         256 /* Frames per measurement */
+#define BENCH_PINS_PER_PORT  32
+#define BENCH_EVAL_STRIDE_MS 37  /* Time between evaluated frames */
+
+static const struct device *const ports[] = {
+    DT_FOREACH_CHILD_STATUS_OKAY_SEP(DT_NODELABEL(bench_ports),
+                                     DEVICE_DT_GET, (,))
+};
+
+BUILD_ASSERT(ARRAY_SIZE(ports) * BENCH_PINS_PER_PORT >= LED_FRAME_MAX_LEDS,
+             "Fewer emulated GPIO pins than CONFIG_LED_SHOW_MAX_LEDS");
+BUILD_ASSERT(ARRAY_SIZE(ports) <= LED_FRAME_MAX_PORTS,
+             "More emulated GPIO ports than CONFIG_LED_SHOW_MAX_PORTS");
+
+/* LED counts measured, up to CONFIG_LED_SHOW_MAX_LEDS */
+static const size_t led_counts[] = { 4, 8, 16, 32, 64, 128, 256, 512, 1024 };
+
+/* LED counts of the blend kernels, which do not need frames or GPIOs */
+static const size_t blend_counts[] = { 64, 256, 1024, 4096 };
+#define BENCH_BLEND_MAX_LEDS 4096
+
+static uint32_t blend_dst[BENCH_BLEND_MAX_LEDS / LED_BLEND_LANES];
+static uint32_t blend_src[BENCH_BLEND_MAX_LEDS / LED_BLEND_LANES];
+
+static const char *const blend_names[LED_BLEND_MODE_COUNT] = {
+    [LED_BLEND_ADD] = "add",
+    [LED_BLEND_MAX] = "max",
+    [LED_BLEND_MULTIPLY] = "multiply",
+    [LED_BLEND_ALPHA] = "alpha",
+};
+
+/* Overlays of the "layers" row: as the default playlist of the show */
+static const struct led_layer overlays[] = {
+    { .effect = LED_EFFECT_SPARKLE, .mode = LED_BLEND_ADD, .opacity = 64 },
+    { .effect = LED_EFFECT_BREATHE, .mode = LED_BLEND_MULTIPLY,
+      .opacity = 128 },
+};
+
+static struct gpio_dt_spec specs[LED_FRAME_MAX_LEDS];
+
+/* All on / all off: every LED changes on every frame */
+static struct led_frame frames[2];
+
+/* ============================================================================
+ * MEASUREMENTS
+ * ============================================================================
+ * Each returns the timing cycles spent on BENCH_FRAMES frames.
+ */
+
+/**
+ * @brief Per-LED write, one driver call per LED
+ */
+static inline void set_led(size_t led, bool on)
+{
+    gpio_pin_set_dt(&specs[led], on);
+}
+
+static uint64_t bench_set_led(size_t leds)
+{
+    timing_t start, end;
+
+    start = timing_counter_get();
+
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        const struct led_frame *frame = &frames[f & 1];
+
+        for (size_t i = 0; i < leds; i++) {
+            set_led(i, led_frame_test(frame, i));
+        }
+    }
+
+    end = timing_counter_get();
+
+    return timing_cycles_get(&start, &end);
+}
+
+static uint64_t bench_commit(bool toggle)
+{
+    timing_t start, end;
+
+    start = timing_counter_get();
+
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        led_frame_commit(&frames[toggle ? (f & 1) : 0]);
+    }
+
+    end = timing_counter_get();
+
+    return timing_cycles_get(&start, &end);
+}
+
+static uint64_t bench_effect(const struct led_effect *effect)
+{
+    struct led_frame frame;
+    struct led_step step = { .frame = &frame };
+    struct effect_state state = { 0 };
+    timing_t start, end;
+
+    start = timing_counter_get();
+
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        effect->step(effect, &state, &step);
+    }
+
+    end = timing_counter_get();
+
+    return timing_cycles_get(&start, &end);
+}
+
+/**
+ * @brief Time function at scattered points, as when seeking or dropping
+ */
+static uint64_t bench_eval(const struct led_effect *effect)
+{
+    struct led_frame frame;
+    struct led_step step = { .frame = &frame };
+    timing_t start, end;
+
+    start = timing_counter_get();
+
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        effect->eval(effect, (uint32_t)f * BENCH_EVAL_STRIDE_MS, &step);
+    }
+
+    end = timing_counter_get();
+
+    return timing_cycles_get(&start, &end);
+}
+
+/**
+ * @brief BAM planes of a plain frame, or of two frames blended
+ */
+static uint64_t bench_bam(bool blend)
+{
+    timing_t start, end;
+
+    start = timing_counter_get();
+
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        if (blend) {
+            led_bam_set_blend(&frames[f & 1], (uint8_t)f,
+                              &frames[(f + 1) & 1], (uint8_t)~f);
+        } else {
+            led_bam_set_frame(&frames[f & 1], (uint8_t)f);
+        }
+    }
+
+    end = timing_counter_get();
+
+    return timing_cycles_get(&start, &end);
+}
+
+/**
+ * @brief Frame of a cross-fade: both effects stepped, then blended
+ *
+ * With @p to NULL, the baseline: @p from alone, as a plain frame.
+ */
+static uint64_t bench_fade(const struct led_effect *from,
+                           const struct led_effect *to)
+{
+    struct led_frame frame_a, frame_b;
+    struct led_step step_a = { .frame = &frame_a };
+    struct led_step step_b = { .frame = &frame_b };
+    struct effect_state state_a = { 0 };
+    struct effect_state state_b = { 0 };
+    timing_t start, end;
+
+    start = timing_counter_get();
+
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        from->step(from, &state_a, &step_a);
+        if (to == NULL) {
+            led_bam_set_frame(&frame_a, (uint8_t)~f);
+            continue;
+        }
+        to->step(to, &state_b, &step_b);
+        led_bam_set_blend(&frame_a, (uint8_t)~f, &frame_b, (uint8_t)f);
+    }
+
+    end = timing_counter_get();
+
+    return timing_cycles_get(&start, &end);
+}
+
+/**
+ * @brief One blend kernel over @p leds levels
+ */
+static uint64_t bench_blend(enum led_blend_mode mode, size_t leds,
+                            uint8_t opacity)
+{
+    size_t words = leds / LED_BLEND_LANES;
+    timing_t start, end;
+
+    start = timing_counter_get();
+
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        led_blend(mode, blend_dst, blend_src, words, opacity);
+    }
+
+    end = timing_counter_get();
+
+    return timing_cycles_get(&start, &end);
+}
+
+/**
+ * @brief Frame expanded to levels with the overlay layers composited on
+ */
+static uint64_t bench_layers(void)
+{
+    static struct led_levels levels;
+    timing_t start, end;
+
+    start = timing_counter_get();
+
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        led_levels_from_frame(&levels, &frames[f & 1], LED_LEVEL_FULL);
+        led_layers_render(overlays, ARRAY_SIZE(overlays),
+                          (uint32_t)f * BENCH_EVAL_STRIDE_MS, &levels);
+    }
+
+    end = timing_counter_get();
+
+    return timing_cycles_get(&start, &end);
+}
+
+/**
+ * @brief Print one result line
+ */
+static void bench_report(const char *test, size_t leds, uint64_t cycles)
+{
+    uint64_t ns = timing_cycles_to_ns(cycles);
+    /* LEDs per us = millions per second, in hundredths */
+    uint64_t mleds = (ns > 0) ? (uint64_t)leds * BENCH_FRAMES * 100000U / ns
+                              : 0;
+
+    printf("BENCH,%s,%u,%u,%u,%u.%02u\n", test, (unsigned int)leds,
+           (unsigned int)(cycles / BENCH_FRAMES),
+           (unsigned int)(ns / BENCH_FRAMES),
+           (unsigned int)(mleds / 100), (unsigned int)(mleds % 100));
+}
+
+/* ============================================================================
+ * MAIN FUNCTION
+ * ============================================================================
+ */
+
+int main(void)
+{
+    size_t num_effects;
+    int ret;
+
+    /* LED N is pin N % 32 of port N / 32 */
+    for (size_t i = 0; i < LED_FRAME_MAX_LEDS; i++) {
+        specs[i].port = ports[i / BENCH_PINS_PER_PORT];
+        specs[i].pin = i % BENCH_PINS_PER_PORT;
+        specs[i].dt_flags = GPIO_ACTIVE_HIGH;
+    }
+
+    for (size_t p = 0; p < ARRAY_SIZE(ports); p++) {
+        if (!device_is_ready(ports[p])) {
+            printf("[ERROR] GPIO port %u not ready\n", (unsigned int)p);
+            return -1;
+        }
+        for (gpio_pin_t pin = 0; pin < BENCH_PINS_PER_PORT; pin++) {
+            ret = gpio_pin_configure(ports[p], pin, GPIO_OUTPUT_INACTIVE);
+            if (ret < 0) {
+                printf("[ERROR] Failed to configure pin %u (err=%d)\n",
+                       pin, ret);
+                return -1;
+            }
+        }
+    }
+
+    timing_init();
+    timing_start();
+
+    printf("# %u frames per test, timing counter %u MHz\n",
+           BENCH_FRAMES, (unsigned int)timing_freq_get_mhz());
+    printf("BENCH,test,leds,cycles_per_frame,ns_per_frame,mleds_per_s\n");
+
+    for (size_t c = 0; c < ARRAY_SIZE(led_counts); c++) {
+        size_t leds = led_counts[c];
+
+        if (leds > LED_FRAME_MAX_LEDS) {
+            break;
+        }
+
+        /* Frames and effects cover exactly "leds" from here on */
+        ret = led_frame_init(specs, leds);
+        if (ret < 0) {
+            printf("[ERROR] Frame setup failed for %u LEDs (err=%d)\n",
+                   (unsigned int)leds, ret);
+            return -1;
+        }
+        led_frame_fill(&frames[0], (led_mask_t)~0U);
+
+        bench_report("set_led", leds, bench_set_led(leds));
+        bench_report("commit_changed", leds, bench_commit(true));
+        bench_report("commit_unchanged", leds, bench_commit(false));
+        bench_report("bam_frame", leds, bench_bam(false));
+        bench_report("bam_blend", leds, bench_bam(true));
+
+        /* Every effect enabled in Kconfig */
+        STRUCT_SECTION_FOREACH(led_effect, effect) {
+            bench_report(effect->name, leds, bench_effect(effect));
+        }
+
+        /* Their time functions */
+        STRUCT_SECTION_FOREACH(led_effect, effect) {
+            char name[32];
+
+            if (effect->eval == NULL) {
+                continue;
+            }
+            snprintf(name, sizeof(name), "eval:%s", effect->name);
+            bench_report(name, leds, bench_eval(effect));
+        }
+
+        /* Every effect fading into the next one, the last into the first */
+        STRUCT_SECTION_COUNT(led_effect, &num_effects);
+        for (size_t e = 0; e < num_effects; e++) {
+            struct led_effect *from, *to;
+            char name[32];
+
+            STRUCT_SECTION_GET(led_effect, e, &from);
+            STRUCT_SECTION_GET(led_effect, (e + 1) % num_effects, &to);
+            snprintf(name, sizeof(name), "single:%s", from->name);
+            bench_report(name, leds, bench_fade(from, NULL));
+            snprintf(name, sizeof(name), "fade:%s", from->name);
+            bench_report(name, leds, bench_fade(from, to));
+        }
+
+        /* Default overlay stack, if its effects have time functions */
+        if (led_layers_validate(overlays, ARRAY_SIZE(overlays)) == 0) {
+            bench_report("layers", leds, bench_layers());
+        }
+
+        /* The same effects played by the bytecode VM */
+        for (size_t e = 0; e < led_vm_num_effects; e++) {
+            char name[32];
+
+            snprintf(name, sizeof(name), "vm:%s", led_vm_effects[e].name);
+            bench_report(name, leds, bench_effect(&led_vm_effects[e]));
+        }
+    }
+
+    /* Blend kernels, over pseudo-random levels */
+    for (size_t i = 0; i < ARRAY_SIZE(blend_src); i++) {
+        blend_src[i] = (uint32_t)i * 0x9E3779B9U;
+    }
+
+    for (size_t c = 0; c < ARRAY_SIZE(blend_counts); c++) {
+        for (int mode = 0; mode < LED_BLEND_MODE_COUNT; mode++) {
+            char name[32];
+
+            snprintf(name, sizeof(name), "blend_%s", blend_names[mode]);
+            bench_report(name, blend_counts[c],
+                         bench_blend(mode, blend_counts[c], LED_BLEND_OPAQUE));
+            snprintf(name, sizeof(name), "blend_%s_50", blend_names[mode]);
+            bench_report(name, blend_counts[c],
+                         bench_blend(mode, blend_counts[c], 128));
+        }
+    }
+
+    timing_stop();
+    printf("BENCH,done\n");
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * Show Control Buttons
+ *
+ * Description: One GPIO callback per button, edge-to-active interrupts,
+ *              and a time-based debounce so a bouncing contact is reported
+ *              as a single press.
+ *
+ * License:     MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+
+#include "buttons.h"
+
+/* Presses closer together than this are contact bounce */
+#define DEBOUNCE_MS 50
+
+#define BUTTON_SPEC(n) GPIO_DT_SPEC_GET_OR(DT_ALIAS(sw##n), gpios, { 0 })
+
+static const struct gpio_dt_spec button_specs[BUTTONS_MAX] = {
+    BUTTON_SPEC(0),
+    BUTTON_SPEC(1),
+    BUTTON_SPEC(2),
+    BUTTON_SPEC(3),
+};
+
+/**
+ * @brief Runtime state of one button
+ */
+struct button {
+    struct gpio_callback cb;
+    int64_t last_press_ms;
+};
+
+static struct button buttons[BUTTONS_MAX];
+static button_handler_t press_handler;
+
+/**
+ * @brief GPIO ISR: debounce and report a press
+ */
+static void button_isr(const struct device *port, struct gpio_callback *cb,
+                       gpio_port_pins_t pins)
+{
+    struct button *btn = CONTAINER_OF(cb, struct button, cb);
+    int64_t now = k_uptime_get();
+
+    ARG_UNUSED(port);
+    ARG_UNUSED(pins);
+
+    if (now - btn->last_press_ms < DEBOUNCE_MS) {
+        return;
+    }
+    btn->last_press_ms = now;
+
+    press_handler((int)(btn - buttons));
+}
+
+int buttons_init(button_handler_t handler)
+{
+    int enabled = 0;
+    int ret;
+
+    press_handler = handler;
+
+    for (int i = 0; i < BUTTONS_MAX; i++) {
+        const struct gpio_dt_spec *spec = &button_specs[i];
+
+        if (spec->port == NULL) {
+            continue;
+        }
+        if (!gpio_is_ready_dt(spec)) {
+            return -ENODEV;
+        }
+
+        ret = gpio_pin_configure_dt(spec, GPIO_INPUT);
+        if (ret < 0) {
+            return ret;
+        }
+
+        ret = gpio_pin_interrupt_configure_dt(spec, GPIO_INT_EDGE_TO_ACTIVE);
+        if (ret < 0) {
+            return ret;
+        }
+
+        gpio_init_callback(&buttons[i].cb, button_isr, BIT(spec->pin));
+        ret = gpio_add_callback_dt(spec, &buttons[i].cb);
+        if (ret < 0) {
+            return ret;
+        }
+        enabled++;
+    }
+
+    return enabled;
+}
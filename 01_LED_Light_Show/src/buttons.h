@@ -0,0 +1,37 @@
+/*
+ * Show Control Buttons
+ *
+ * Description: Interrupt-driven handling of the DK buttons (sw0..sw3
+ *              devicetree aliases). Presses are debounced in the ISR and
+ *              reported to a callback, still in ISR context.
+ *
+ * License:     MIT
+ */
+
+#ifndef BUTTONS_H_
+#define BUTTONS_H_
+
+/** Number of button aliases looked up (sw0..sw3) */
+#define BUTTONS_MAX 4
+
+/**
+ * @brief Button press callback
+ *
+ * Runs in interrupt context: only ISR-safe calls are allowed.
+ *
+ * @param button Index of the pressed button (N for alias swN)
+ */
+typedef void (*button_handler_t)(int button);
+
+/**
+ * @brief Configure the buttons and enable their interrupts
+ *
+ * Aliases missing from the devicetree are skipped.
+ *
+ * @param handler Called on every debounced press
+ *
+ * @return Number of buttons enabled, or a negative error code
+ */
+int buttons_init(button_handler_t handler);
+
+#endif /* BUTTONS_H_ */
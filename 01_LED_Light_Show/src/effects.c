@@ -0,0 +1,72 @@
+/*
+ * LED Effects
+ *
+ * Description: The effects themselves live in effects/, one file each.
+ *              The linker collects their descriptors into the led_effect
+ *              iterable section; at boot that section is indexed once into
+ *              a table by id, so lookups are a bounds check and a load.
+ *              An effect with an id out of range or already taken is
+ *              logged and left out of the table.
+ *
+ * License:     MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/logging/log.h>
+
+#include "effects.h"
+
+LOG_MODULE_REGISTER(led_effects, CONFIG_LED_SHOW_LOG_LEVEL);
+
+#define EFFECT_NAME(_sym, _name, _cycles)                               \
+    [LED_EFFECT_##_sym] = _name,
+#define EFFECT_NAME_FITS(_sym, _name, _cycles)                          \
+    BUILD_ASSERT(sizeof(_name) <= LED_EFFECT_NAME_LEN,                  \
+                 _name ": name too long");
+
+const char led_effect_names[LED_EFFECT_ID_COUNT][LED_EFFECT_NAME_LEN] = {
+    LED_EFFECT_LIST(EFFECT_NAME)
+};
+
+LED_EFFECT_LIST(EFFECT_NAME_FITS)
+
+static const struct led_effect *effect_by_id[LED_EFFECT_ID_COUNT];
+
+const struct led_effect *led_effect_get(unsigned int id)
+{
+    return (id < LED_EFFECT_ID_COUNT) ? effect_by_id[id] : NULL;
+}
+
+size_t led_effect_count(void)
+{
+    size_t count;
+
+    STRUCT_SECTION_COUNT(led_effect, &count);
+
+    return count;
+}
+
+/**
+ * @brief Index the registered effects by id
+ */
+static int effects_init(void)
+{
+    STRUCT_SECTION_FOREACH(led_effect, effect) {
+        if (effect->id >= LED_EFFECT_ID_COUNT) {
+            LOG_ERR("%s: bad effect id %u, skipped", effect->name,
+                    effect->id);
+            continue;
+        }
+        if (effect_by_id[effect->id] != NULL) {
+            LOG_ERR("%s: effect id %u taken by %s, skipped", effect->name,
+                    effect->id, effect_by_id[effect->id]->name);
+            continue;
+        }
+        effect_by_id[effect->id] = effect;
+    }
+
+    return 0;
+}
+
+SYS_INIT(effects_init, APPLICATION, 0);
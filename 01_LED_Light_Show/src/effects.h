@@ -0,0 +1,83 @@
+/*
+ * LED Effects
+ *
+ * Description: Registry of the effects built into the image. Effects
+ *              register themselves at link time (LED_EFFECT_DEFINE(),
+ *              LED_PATTERN_DEFINE()) and are looked up by id in constant
+ *              time; effects disabled in Kconfig are not built at all.
+ *
+ * License:     MIT
+ */
+
+#ifndef EFFECTS_H_
+#define EFFECTS_H_
+
+#include "led_effect.h"
+
+/**
+ * @brief Every effect: id, name and default cycles per show entry
+ *
+ * In the order of the default show sequence. The C and the bytecode
+ * version of an effect are both registered with the name and cycles
+ * given here, see LED_EFFECT_NAME() and LED_EFFECT_CYCLES().
+ */
+#define LED_EFFECT_LIST(X)                                              \
+    X(KNIGHT_RIDER,    "Knight Rider",    3)                            \
+    X(WAVE,            "Wave",            2)                            \
+    X(ALTERNATE_FLASH, "Alternate Flash", 6)                            \
+    X(CONVERGE,        "Converge",        4)                            \
+    X(BINARY_COUNTER,  "Binary Counter",  2)                            \
+    X(SPARKLE,         "Sparkle",         50)                           \
+    X(BREATHE,         "Breathe",         2)                            \
+    X(CASCADE,         "Cascade",         8)                            \
+    X(GRAND_FINALE,    "Grand Finale",    10)
+
+#define LED_EFFECT_ENUM_ID(_sym, _name, _cycles) LED_EFFECT_##_sym,
+#define LED_EFFECT_ENUM_CYCLES(_sym, _name, _cycles)                    \
+    LED_EFFECT_CYCLES_##_sym = (_cycles),
+
+/**
+ * @brief Effect ids, also the order of the default show sequence
+ */
+enum led_effect_id {
+    LED_EFFECT_LIST(LED_EFFECT_ENUM_ID)
+
+    LED_EFFECT_ID_COUNT
+};
+
+/* Default cycles per effect, LED_EFFECT_CYCLES_<sym> */
+enum {
+    LED_EFFECT_LIST(LED_EFFECT_ENUM_CYCLES)
+};
+
+/** Longest effect name, with its terminating NUL */
+#define LED_EFFECT_NAME_LEN 16
+
+/** Effect names by id, from LED_EFFECT_LIST */
+extern const char led_effect_names[LED_EFFECT_ID_COUNT][LED_EFFECT_NAME_LEN];
+
+/**
+ * @brief Name of effect @p _sym (KNIGHT_RIDER, ...), a constant address
+ */
+#define LED_EFFECT_NAME(_sym) (led_effect_names[LED_EFFECT_##_sym])
+
+/**
+ * @brief Default cycles per show entry of effect @p _sym
+ */
+#define LED_EFFECT_CYCLES(_sym) LED_EFFECT_CYCLES_##_sym
+
+/**
+ * @brief Look up an effect by id
+ *
+ * @param id Effect id, enum led_effect_id
+ *
+ * @return The effect, or NULL if it is not built into the image
+ */
+const struct led_effect *led_effect_get(unsigned int id);
+
+/**
+ * @brief Number of effects built into the image
+ */
+size_t led_effect_count(void);
+
+#endif /* EFFECTS_H_ */
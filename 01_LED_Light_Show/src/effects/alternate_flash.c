@@ -0,0 +1,24 @@
+/*
+ * Alternate Flash Effect
+ *
+ * Description: Even and odd LEDs in turn.
+ *
+ * License:     MIT
+ */
+
+#include "effect_defs.h"
+
+/**
+ * @brief Alternate Flash Effect
+ * 
+ * Alternates between even and odd LEDs.
+ * Pattern: [*-*-] <-> [-*-*]
+ */
+LED_PATTERN_DEFINE(effect_alternate_flash, LED_EFFECT_ALTERNATE_FLASH,
+                   LED_EFFECT_NAME(ALTERNATE_FLASH),
+                   LED_EFFECT_CYCLES(ALTERNATE_FLASH),
+    /* Even LEDs ON (0, 2), Odd LEDs OFF (1, 3) */
+    LED_PATTERN_FRAME(LEDS_EVEN, SLOW_DELAY_MS),
+    /* Odd LEDs ON (1, 3), Even LEDs OFF (0, 2) */
+    LED_PATTERN_FRAME(LEDS_ODD, SLOW_DELAY_MS),
+);
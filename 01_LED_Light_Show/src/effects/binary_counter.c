@@ -0,0 +1,38 @@
+/*
+ * Binary Counter Effect
+ *
+ * Description: Counts 0 to 15 in binary on each group of 4 LEDs.
+ *
+ * License:     MIT
+ */
+
+#include "effect_defs.h"
+
+/**
+ * @brief Binary Counter Effect
+ * 
+ * Displays numbers 0-15 in binary using the 4 LEDs.
+ * LED0 = bit 0 (LSB), LED3 = bit 3 (MSB)
+ * 
+ * Example: 5 (0101) = LED0 ON, LED1 OFF, LED2 ON, LED3 OFF
+ */
+LED_PATTERN_DEFINE(effect_binary_counter, LED_EFFECT_BINARY_COUNTER,
+                   LED_EFFECT_NAME(BINARY_COUNTER),
+                   LED_EFFECT_CYCLES(BINARY_COUNTER),
+    LED_PATTERN_FRAME(0x0, MEDIUM_DELAY_MS),
+    LED_PATTERN_FRAME(0x1, MEDIUM_DELAY_MS),
+    LED_PATTERN_FRAME(0x2, MEDIUM_DELAY_MS),
+    LED_PATTERN_FRAME(0x3, MEDIUM_DELAY_MS),
+    LED_PATTERN_FRAME(0x4, MEDIUM_DELAY_MS),
+    LED_PATTERN_FRAME(0x5, MEDIUM_DELAY_MS),
+    LED_PATTERN_FRAME(0x6, MEDIUM_DELAY_MS),
+    LED_PATTERN_FRAME(0x7, MEDIUM_DELAY_MS),
+    LED_PATTERN_FRAME(0x8, MEDIUM_DELAY_MS),
+    LED_PATTERN_FRAME(0x9, MEDIUM_DELAY_MS),
+    LED_PATTERN_FRAME(0xA, MEDIUM_DELAY_MS),
+    LED_PATTERN_FRAME(0xB, MEDIUM_DELAY_MS),
+    LED_PATTERN_FRAME(0xC, MEDIUM_DELAY_MS),
+    LED_PATTERN_FRAME(0xD, MEDIUM_DELAY_MS),
+    LED_PATTERN_FRAME(0xE, MEDIUM_DELAY_MS),
+    LED_PATTERN_FRAME(0xF, MEDIUM_DELAY_MS),
+);
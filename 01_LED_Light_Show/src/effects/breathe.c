@@ -0,0 +1,127 @@
+/*
+ * Breathe Effect
+ *
+ * Description: All LEDs fading in and out together.
+ *
+ * License:     MIT
+ */
+
+#include "effect_defs.h"
+#include "led_output.h"
+
+/* Dimmed breathe: 50 steps of 10 ms per half breath (1 s per cycle) */
+#define BREATHE_STEPS    50
+#define BREATHE_STEP_MS  10
+
+/* Software PWM breathe: 10 ms period, 10 levels, 5 pulses per level */
+#define SOFT_PWM_PERIOD_MS  10
+#define SOFT_PWM_PULSES     5
+
+/**
+ * @brief Breathe Effect
+ * 
+ * Simulates a breathing/pulsing effect.
+ * All LEDs fade in and out together.
+ * 
+ * With a dimming backend (hardware PWM, see led_pwm.c, or the BAM ISR,
+ * see led_bam.c) the frames ramp an 8-bit level up and down in
+ * BREATHE_STEP_MS steps and the backend generates the carrier.
+ * 
+ * Without one, it falls back to software PWM: alternating full-on and
+ * off frames whose ON time grows from 0 to 9 ms and back.
+ */
+static bool breathe_step(const struct led_effect *effect,
+                         struct effect_state *state, struct led_step *out)
+{
+    uint16_t frame = state->frame++;
+
+    ARG_UNUSED(effect);
+
+    led_frame_fill(out->frame, (led_mask_t)~0U);
+
+    if (led_output_has_dimming()) {
+        /* Fade IN over frames 0..STEPS, fade OUT over STEPS+1..2*STEPS+1 */
+        int step = (frame <= BREATHE_STEPS) ? frame
+                                            : (2 * BREATHE_STEPS + 1 - frame);
+
+        out->level = step * LED_LEVEL_FULL / BREATHE_STEPS;
+        out->duration_ms = BREATHE_STEP_MS;
+
+        if (state->frame == 2 * (BREATHE_STEPS + 1)) {
+            state->frame = 0;
+            return true;
+        }
+        return false;
+    }
+
+    /* Software PWM: even frames ON, odd frames OFF */
+    int pulse = frame / 2;
+    int per_half = 10 * SOFT_PWM_PULSES;
+    int brightness = (pulse < per_half)
+                         ? (pulse / SOFT_PWM_PULSES)
+                         : (10 - (pulse - per_half) / SOFT_PWM_PULSES);
+
+    out->level = LED_LEVEL_FULL;
+    if (frame % 2 == 0) {
+        out->duration_ms = brightness;                        /* ON time */
+    } else {
+        led_frame_clear(out->frame);
+        out->duration_ms = SOFT_PWM_PERIOD_MS - brightness;   /* OFF time */
+    }
+
+    if (state->frame == 4 * per_half) {
+        state->frame = 0;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Breathe as a function of time
+ *
+ * Same frames as breathe_step(); the soft PWM pulses of 0 ms ON time
+ * that the step function emits are left out.
+ */
+static uint32_t breathe_eval(const struct led_effect *effect, uint32_t t_ms,
+                             struct led_step *out)
+{
+    ARG_UNUSED(effect);
+
+    led_frame_fill(out->frame, (led_mask_t)~0U);
+
+    if (led_output_has_dimming()) {
+        uint32_t period_ms = 2 * (BREATHE_STEPS + 1) * BREATHE_STEP_MS;
+        uint32_t frame = (t_ms % period_ms) / BREATHE_STEP_MS;
+        uint32_t step = (frame <= BREATHE_STEPS)
+                            ? frame
+                            : (2 * BREATHE_STEPS + 1 - frame);
+
+        out->level = step * LED_LEVEL_FULL / BREATHE_STEPS;
+        out->duration_ms = BREATHE_STEP_MS - t_ms % BREATHE_STEP_MS;
+
+        return period_ms;
+    }
+
+    /* Software PWM: ON for "brightness" ms at the start of every period */
+    uint32_t per_half = 10 * SOFT_PWM_PULSES;
+    uint32_t period_ms = 2 * per_half * SOFT_PWM_PERIOD_MS;
+    uint32_t pulse = (t_ms % period_ms) / SOFT_PWM_PERIOD_MS;
+    uint32_t phase = t_ms % SOFT_PWM_PERIOD_MS;
+    uint32_t brightness = (pulse < per_half)
+                              ? (pulse / SOFT_PWM_PULSES)
+                              : (10 - (pulse - per_half) / SOFT_PWM_PULSES);
+
+    out->level = LED_LEVEL_FULL;
+    if (phase < brightness) {
+        out->duration_ms = brightness - phase;
+    } else {
+        led_frame_clear(out->frame);
+        out->duration_ms = SOFT_PWM_PERIOD_MS - phase;
+    }
+
+    return period_ms;
+}
+
+LED_EFFECT_DEFINE_EVAL(effect_breathe, LED_EFFECT_BREATHE,
+                       LED_EFFECT_NAME(BREATHE), breathe_step, breathe_eval,
+                       NULL, LED_EFFECT_CYCLES(BREATHE));
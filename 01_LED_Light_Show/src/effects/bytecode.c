@@ -0,0 +1,152 @@
+/*
+ * LED Effects as Bytecode
+ *
+ * Description: The effects of this directory as programs for the
+ *              bytecode VM (led_vm.h), 5 to 11 bytes each. With
+ *              CONFIG_LED_SHOW_EFFECTS_BYTECODE they are registered under
+ *              the ids of the C effects, which are then not built; the
+ *              benchmark plays them next to the C versions. Every
+ *              program is checked with led_vm_validate() at boot.
+ *
+ * License:     MIT
+ */
+
+#include <zephyr/init.h>
+#include <zephyr/logging/log.h>
+
+#include "effect_defs.h"
+#include "effects_vm.h"
+#include "led_vm.h"
+
+LOG_MODULE_REGISTER(led_vm, CONFIG_LED_SHOW_LOG_LEVEL);
+
+/* ============================================================================
+ * PROGRAMS
+ * ============================================================================
+ */
+
+/* [*---] -> [-*--] -> [--*-] -> [---*] -> [--*-] -> [-*--] -> [*---] */
+LED_VM_PROGRAM_DEFINE(vm_knight_rider,
+    VM_TEMPO(MEDIUM_DELAY_MS),
+    VM_SHOW(0x1), VM_SHOW(0x2), VM_SHOW(0x4), VM_SHOW(0x8),
+    VM_SHOW(0x4), VM_SHOW(0x2), VM_SHOW(0x1),
+    VM_END);
+
+/* Fill from LED 0, then empty from LED 0 */
+LED_VM_PROGRAM_DEFINE(vm_wave,
+    VM_TEMPO(SLOW_DELAY_MS),
+    VM_SHOW(0x1), VM_SHOW(0x3), VM_SHOW(0x7), VM_SHOW(0xF),
+    VM_SHOW(0xE), VM_SHOW(0xC), VM_SHOW(0x8), VM_SHOW(0x0),
+    VM_END);
+
+LED_VM_PROGRAM_DEFINE(vm_alternate_flash,
+    VM_TEMPO(SLOW_DELAY_MS),
+    VM_SHOW(LEDS_EVEN), VM_SHOW(LEDS_ODD),
+    VM_END);
+
+LED_VM_PROGRAM_DEFINE(vm_converge,
+    VM_TEMPO(SLOW_DELAY_MS),
+    VM_SHOW(LEDS_OUTER), VM_SHOW(LEDS_INNER),
+    VM_END);
+
+/* 0 to 15: show, add one, 16 times */
+LED_VM_PROGRAM_DEFINE(vm_binary_counter,
+    VM_TEMPO(MEDIUM_DELAY_MS),
+    VM_SET(0x0),
+    VM_LOOP(16), VM_WAIT(1), VM_ADD(1), VM_NEXT,
+    VM_END);
+
+/* One random frame per cycle */
+LED_VM_PROGRAM_DEFINE(vm_sparkle,
+    VM_TEMPO(FAST_DELAY_MS),
+    VM_RAND, VM_WAIT(1),
+    VM_END);
+
+/* 10 ms steps, 0 to full and back (soft PWM without dimming) */
+LED_VM_PROGRAM_DEFINE(vm_breathe,
+    VM_TEMPO(10),
+    VM_SET(LEDS_ALL),
+    VM_FADE_UP(50), VM_FADE_DOWN(50),
+    VM_END);
+
+LED_VM_PROGRAM_DEFINE(vm_cascade,
+    VM_TEMPO(FAST_DELAY_MS),
+    VM_SHOW(0x3), VM_SHOW(0x6), VM_SHOW(0xC), VM_SHOW(0x9),
+    VM_END);
+
+LED_VM_PROGRAM_DEFINE(vm_grand_finale,
+    VM_TEMPO(FAST_DELAY_MS),
+    VM_SHOW(LEDS_ALL), VM_SHOW(LEDS_NONE),
+    VM_END);
+
+/* ============================================================================
+ * DESCRIPTORS
+ * ============================================================================
+ * Same ids, names and default cycles as the C effects (LED_EFFECT_LIST).
+ */
+#define VM_EFFECTS(X)                                                   \
+    X(KNIGHT_RIDER,    knight_rider)                                    \
+    X(WAVE,            wave)                                            \
+    X(ALTERNATE_FLASH, alternate_flash)                                 \
+    X(CONVERGE,        converge)                                        \
+    X(BINARY_COUNTER,  binary_counter)                                  \
+    X(SPARKLE,         sparkle)                                         \
+    X(BREATHE,         breathe)                                         \
+    X(CASCADE,         cascade)                                         \
+    X(GRAND_FINALE,    grand_finale)
+
+#define VM_EFFECT_INIT(_sym, _var)                                      \
+    {                                                                   \
+        .name = LED_EFFECT_NAME(_sym),                                  \
+        .step = led_vm_step,                                            \
+        .data = &vm_##_var,                                             \
+        .id = LED_EFFECT_##_sym,                                        \
+        .cycles = LED_EFFECT_CYCLES(_sym),                              \
+    },
+
+const struct led_effect led_vm_effects[] = {
+    VM_EFFECTS(VM_EFFECT_INIT)
+};
+
+const size_t led_vm_num_effects = ARRAY_SIZE(led_vm_effects);
+
+#if defined(CONFIG_LED_SHOW_EFFECTS_BYTECODE)
+#define VM_EFFECT_REGISTER(_sym, _var)                                  \
+    IF_ENABLED(CONFIG_LED_SHOW_EFFECT_##_sym,                           \
+               (LED_EFFECT_DEFINE(effect_##_var, LED_EFFECT_##_sym,     \
+                                  LED_EFFECT_NAME(_sym), led_vm_step,   \
+                                  &vm_##_var,                           \
+                                  LED_EFFECT_CYCLES(_sym));))
+
+VM_EFFECTS(VM_EFFECT_REGISTER)
+#endif
+
+/* ============================================================================
+ * BOOT CHECK
+ * ============================================================================
+ */
+
+/**
+ * @brief Check every program with led_vm_validate()
+ *
+ * The programs are built in, so a failure is a bug in this file: it is
+ * logged, and stops the boot when assertions are enabled.
+ */
+static int vm_effects_check(void)
+{
+    for (size_t i = 0; i < led_vm_num_effects; i++) {
+        const struct led_effect *effect = &led_vm_effects[i];
+        const struct led_vm_program *program = effect->data;
+        int ret = led_vm_validate(program->code, program->len);
+
+        if (ret < 0) {
+            LOG_ERR("%s: invalid program (%d)", effect->name, ret);
+        }
+        __ASSERT(ret == 0, "%s: invalid VM program", effect->name);
+    }
+
+    return 0;
+}
+
+/* After effects_init(): CALL targets are looked up in the registry */
+SYS_INIT(vm_effects_check, APPLICATION, 1);
@@ -0,0 +1,24 @@
+/*
+ * Cascade Effect
+ *
+ * Description: Two adjacent LEDs rotating around the group.
+ *
+ * License:     MIT
+ */
+
+#include "effect_defs.h"
+
+/**
+ * @brief Cascade Effect
+ * 
+ * Two adjacent LEDs rotate around all 4 positions.
+ * Pattern: [**--] -> [-**-] -> [--**] -> [*--*] -> ...
+ */
+LED_PATTERN_DEFINE(effect_cascade, LED_EFFECT_CASCADE,
+                   LED_EFFECT_NAME(CASCADE),
+                   LED_EFFECT_CYCLES(CASCADE),
+    LED_PATTERN_FRAME(BIT(0) | BIT(1), FAST_DELAY_MS),
+    LED_PATTERN_FRAME(BIT(1) | BIT(2), FAST_DELAY_MS),
+    LED_PATTERN_FRAME(BIT(2) | BIT(3), FAST_DELAY_MS),
+    LED_PATTERN_FRAME(BIT(3) | BIT(0), FAST_DELAY_MS),
+);
@@ -0,0 +1,24 @@
+/*
+ * Converge Effect
+ *
+ * Description: Outer and inner LEDs in turn.
+ *
+ * License:     MIT
+ */
+
+#include "effect_defs.h"
+
+/**
+ * @brief Converge Effect
+ * 
+ * LEDs light from outside to inside and vice versa.
+ * Pattern: [*--*] <-> [-**-]
+ */
+LED_PATTERN_DEFINE(effect_converge, LED_EFFECT_CONVERGE,
+                   LED_EFFECT_NAME(CONVERGE),
+                   LED_EFFECT_CYCLES(CONVERGE),
+    /* Outer LEDs ON (0 and 3) */
+    LED_PATTERN_FRAME(LEDS_OUTER, SLOW_DELAY_MS),
+    /* Inner LEDs ON (1 and 2) */
+    LED_PATTERN_FRAME(LEDS_INNER, SLOW_DELAY_MS),
+);
@@ -0,0 +1,48 @@
+/*
+ * LED Effect Definitions
+ *
+ * Description: Timings and frame masks shared by the effect sources in
+ *              this directory. Every effect is one file that registers
+ *              itself with LED_EFFECT_DEFINE() or LED_PATTERN_DEFINE(),
+ *              built only when its CONFIG_LED_SHOW_EFFECT_* option is set.
+ *
+ * License:     MIT
+ */
+
+#ifndef EFFECT_DEFS_H_
+#define EFFECT_DEFS_H_
+
+#include <zephyr/kernel.h>
+
+#include "effects.h"
+#include "led_pattern.h"
+#include "led_tempo.h"
+
+/* ============================================================================
+ * TIMING DEFINITIONS
+ * ============================================================================
+ * Steps are fractions of a beat, see led_tempo.h; the real duration
+ * follows the show tempo (50 / 100 / 200 ms at 150 BPM).
+ */
+#define FAST_DELAY_MS    LED_TEMPO_BEATS_MS(1, 8) /* Sparkle, cascade */
+#define MEDIUM_DELAY_MS  LED_TEMPO_BEATS_MS(1, 4) /* Knight rider, binary */
+#define SLOW_DELAY_MS    LED_TEMPO_BEATS_MS(1, 2) /* Wave, converge */
+
+/* ============================================================================
+ * FRAME DEFINITIONS
+ * ============================================================================
+ * Every frame is built as a bit-packed buffer (bit N = LED N) and applied
+ * in one go by the output stage, see led_output.c and led_frame.c.
+ * Pattern frames describe a group of 4 LEDs that repeats along the LED
+ * set (see led_pattern.h).
+ */
+
+/* Frequently used frames (one group of 4 LEDs) */
+#define LEDS_NONE   ((led_mask_t)0)
+#define LEDS_ALL    ((led_mask_t)BIT_MASK(LED_PATTERN_GROUP))
+#define LEDS_EVEN   ((led_mask_t)(BIT(0) | BIT(2)))
+#define LEDS_ODD    ((led_mask_t)(BIT(1) | BIT(3)))
+#define LEDS_OUTER  ((led_mask_t)(BIT(0) | BIT(LED_PATTERN_GROUP - 1)))
+#define LEDS_INNER  ((led_mask_t)(BIT(1) | BIT(2)))
+
+#endif /* EFFECT_DEFS_H_ */
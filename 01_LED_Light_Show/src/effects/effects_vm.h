@@ -0,0 +1,24 @@
+/*
+ * LED Effects as Bytecode
+ *
+ * Description: Descriptors of the bytecode versions of the effects
+ *              (bytecode.c), not registered, for side-by-side runs with
+ *              the C versions.
+ *
+ * License:     MIT
+ */
+
+#ifndef EFFECTS_VM_H_
+#define EFFECTS_VM_H_
+
+#include <stddef.h>
+
+#include "led_effect.h"
+
+/** Bytecode versions of the effects, in effect id order */
+extern const struct led_effect led_vm_effects[];
+
+/** Number of entries in led_vm_effects */
+extern const size_t led_vm_num_effects;
+
+#endif /* EFFECTS_VM_H_ */
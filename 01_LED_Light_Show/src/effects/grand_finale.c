@@ -0,0 +1,22 @@
+/*
+ * Grand Finale Effect
+ *
+ * Description: Rapid flashing of all LEDs.
+ *
+ * License:     MIT
+ */
+
+#include "effect_defs.h"
+
+/**
+ * @brief Grand Finale Effect
+ * 
+ * Rapid flashing of all LEDs.
+ * Pattern: [****] <-> [----]
+ */
+LED_PATTERN_DEFINE(effect_grand_finale, LED_EFFECT_GRAND_FINALE,
+                   LED_EFFECT_NAME(GRAND_FINALE),
+                   LED_EFFECT_CYCLES(GRAND_FINALE),
+    LED_PATTERN_FRAME(LEDS_ALL, FAST_DELAY_MS),
+    LED_PATTERN_FRAME(LEDS_NONE, FAST_DELAY_MS),
+);
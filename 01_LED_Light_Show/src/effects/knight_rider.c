@@ -0,0 +1,31 @@
+/*
+ * Knight Rider Effect
+ *
+ * Description: Scanning light, back and forth.
+ *
+ * License:     MIT
+ */
+
+#include "effect_defs.h"
+
+/**
+ * @brief Knight Rider Effect
+ * 
+ * Classic scanning LED effect, moving back and forth.
+ * Pattern: [*---] -> [-*--] -> [--*-] -> [---*] -> [--*-] -> ...
+ * 
+ * One cycle is a complete back-and-forth sweep.
+ */
+LED_PATTERN_DEFINE(effect_knight_rider, LED_EFFECT_KNIGHT_RIDER,
+                   LED_EFFECT_NAME(KNIGHT_RIDER),
+                   LED_EFFECT_CYCLES(KNIGHT_RIDER),
+    /* Forward sweep: LED 0 to LED 3 */
+    LED_PATTERN_FRAME(BIT(0), MEDIUM_DELAY_MS),
+    LED_PATTERN_FRAME(BIT(1), MEDIUM_DELAY_MS),
+    LED_PATTERN_FRAME(BIT(2), MEDIUM_DELAY_MS),
+    LED_PATTERN_FRAME(BIT(3), MEDIUM_DELAY_MS),
+    /* Backward sweep: LED 2 to LED 0 */
+    LED_PATTERN_FRAME(BIT(2), MEDIUM_DELAY_MS),
+    LED_PATTERN_FRAME(BIT(1), MEDIUM_DELAY_MS),
+    LED_PATTERN_FRAME(BIT(0), MEDIUM_DELAY_MS),
+);
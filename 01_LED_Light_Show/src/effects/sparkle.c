@@ -0,0 +1,51 @@
+/*
+ * Sparkle Effect
+ *
+ * Description: Pseudo-random twinkling, one random word per 32 LEDs.
+ *
+ * License:     MIT
+ */
+
+#include "effect_defs.h"
+
+/**
+ * @brief Sparkle Effect
+ * 
+ * Creates a pseudo-random twinkling pattern, see led_pattern_random().
+ * 
+ * Every frame is a complete cycle, so the show's cycle count is the
+ * number of random pattern iterations. The generator is re-seeded from
+ * the step counter in state->frame, so no extra state is needed.
+ */
+static bool sparkle_step(const struct led_effect *effect,
+                         struct effect_state *state, struct led_step *out)
+{
+    ARG_UNUSED(effect);
+
+    led_pattern_random(out->frame, ++state->frame);
+    out->level = LED_LEVEL_FULL;
+    out->duration_ms = FAST_DELAY_MS;
+
+    return true;
+}
+
+/**
+ * @brief Sparkle as a function of time
+ *
+ * Frame N (from 0) is seeded with N + 1, the same frames as sparkle_step().
+ */
+static uint32_t sparkle_eval(const struct led_effect *effect, uint32_t t_ms,
+                             struct led_step *out)
+{
+    ARG_UNUSED(effect);
+
+    led_pattern_random(out->frame, t_ms / FAST_DELAY_MS + 1);
+    out->level = LED_LEVEL_FULL;
+    out->duration_ms = FAST_DELAY_MS - t_ms % FAST_DELAY_MS;
+
+    return FAST_DELAY_MS;
+}
+
+LED_EFFECT_DEFINE_EVAL(effect_sparkle, LED_EFFECT_SPARKLE,
+                       LED_EFFECT_NAME(SPARKLE), sparkle_step, sparkle_eval,
+                       NULL, LED_EFFECT_CYCLES(SPARKLE));
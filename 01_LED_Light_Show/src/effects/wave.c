@@ -0,0 +1,33 @@
+/*
+ * Wave Effect
+ *
+ * Description: Progressive fill and empty.
+ *
+ * License:     MIT
+ */
+
+#include "effect_defs.h"
+
+/**
+ * @brief Wave Effect
+ * 
+ * Progressive fill and empty effect.
+ * Fill:  [*---] -> [**--] -> [***-] -> [****]
+ * Empty: [****] -> [-***] -> [--**] -> [---*] -> [----]
+ * 
+ * One cycle is a complete fill/empty.
+ */
+LED_PATTERN_DEFINE(effect_wave, LED_EFFECT_WAVE,
+                   LED_EFFECT_NAME(WAVE),
+                   LED_EFFECT_CYCLES(WAVE),
+    /* Progressive fill from LED 0 to LED 3 */
+    LED_PATTERN_FRAME(0x1, SLOW_DELAY_MS),
+    LED_PATTERN_FRAME(0x3, SLOW_DELAY_MS),
+    LED_PATTERN_FRAME(0x7, SLOW_DELAY_MS),
+    LED_PATTERN_FRAME(0xF, SLOW_DELAY_MS),
+    /* Progressive empty from LED 0 to LED 3 */
+    LED_PATTERN_FRAME(0xE, SLOW_DELAY_MS),
+    LED_PATTERN_FRAME(0xC, SLOW_DELAY_MS),
+    LED_PATTERN_FRAME(0x8, SLOW_DELAY_MS),
+    LED_PATTERN_FRAME(0x0, SLOW_DELAY_MS),
+);
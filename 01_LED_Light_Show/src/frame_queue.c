@@ -0,0 +1,338 @@
+/*
+ * Frame Output Queue
+ *
+ * Description: Ring indexes are free-running counters; the producer only
+ *              writes the tail and the consumer (output thread) only
+ *              writes the head, so neither side ever takes a lock. A flush
+ *              bumps an epoch instead of touching the consumer's index:
+ *              stale frames are recognised and dropped by the consumer.
+ *
+ *              The output timer is armed for the deadline of the frame at
+ *              the head of the ring. "armed" tells the producer whether it
+ *              has to start the timer for a frame queued into an idle ring.
+ *              The timer ISR only wakes the output thread; the frames are
+ *              committed there, so GPIO expanders on I2C or SPI, PWM
+ *              drivers and the strip render never run in an ISR.
+ *
+ *              Drift is measured against the cycle counter, not the tick
+ *              the frame was due at: the time elapsed between the first
+ *              frame after a flush and the current one, minus the show
+ *              time between their deadlines. Lateness of single frames
+ *              and any slip of the timeline add up in it.
+ *
+ * License:     MIT
+ */
+
+#include "frame_queue.h"
+#include "frame_stats.h"
+#include "frame_trace.h"
+#include "frame_vcd.h"
+#include "led_output.h"
+
+#define RING_SIZE CONFIG_LED_SHOW_RING_DEPTH
+#define RING_MASK (RING_SIZE - 1)
+
+BUILD_ASSERT((RING_SIZE & RING_MASK) == 0,
+             "CONFIG_LED_SHOW_RING_DEPTH must be a power of two");
+
+static struct led_qframe ring[RING_SIZE];
+static atomic_t head;       /* Next slot to consume, output thread */
+static atomic_t tail;       /* Next slot to produce, written by renderer */
+static atomic_t epoch;      /* Current flush generation */
+static atomic_t armed;      /* Output timer is pending */
+
+static frame_queue_refill_t refill_cb;
+static void *refill_data;
+
+static struct frame_queue_stats stats;
+static k_ticks_t max_late;
+
+/* Drift reference: first frame of the current timeline */
+static bool anchored;
+static k_ticks_t anchor_deadline;
+static uint32_t last_cycles;        /* Cycle count at the last frame */
+static uint64_t elapsed_cycles;     /* Cycles since the anchor frame */
+
+static void output_expiry(struct k_timer *timer);
+static K_TIMER_DEFINE(output_timer, output_expiry, NULL);
+
+/* Given by the output timer at a deadline */
+static K_SEM_DEFINE(output_sem, 0, 1);
+
+/* ============================================================================
+ * OUTPUT THREAD
+ * ============================================================================
+ */
+
+/**
+ * @brief Hand a frame to the output stage, by the kind of frame
+ */
+static void output_apply(const struct led_qframe *frame)
+{
+#if defined(CONFIG_LED_SHOW_LEVELS)
+    if (frame->flags & FRAME_FLAG_LEVELS) {
+        led_output_apply_levels(&frame->levels);
+        return;
+    }
+#endif
+#if defined(CONFIG_LED_SHOW_FADE)
+    if (frame->flags & FRAME_FLAG_BLEND) {
+        led_output_apply_blend(&frame->frame, frame->level, &frame->frame2,
+                               frame->level2,
+                               (frame->flags & FRAME_FLAG_CUT) != 0);
+        return;
+    }
+#endif
+    led_output_apply(&frame->frame, frame->level);
+}
+
+/**
+ * @brief Record a committed frame in the trace and the VCD dump
+ *
+ * A blended frame is recorded as the LEDs of both layers, at the level of
+ * the brighter one; a frame of levels as its LEDs at half brightness or
+ * more (led_levels_to_frame()), at full level.
+ */
+static void output_record(const struct led_qframe *frame)
+{
+#if defined(CONFIG_LED_SHOW_FADE) || defined(CONFIG_LED_SHOW_LEVELS)
+    /* Output thread only */
+    static struct led_frame shown;
+#endif
+    const struct led_frame *leds = &frame->frame;
+    uint8_t level = frame->level;
+
+    if (!IS_ENABLED(CONFIG_LED_SHOW_TRACE) &&
+        !IS_ENABLED(CONFIG_LED_SHOW_VCD)) {
+        return;
+    }
+
+#if defined(CONFIG_LED_SHOW_LEVELS)
+    if (frame->flags & FRAME_FLAG_LEVELS) {
+        led_levels_to_frame(&frame->levels, &shown);
+        leds = &shown;
+        level = LED_LEVEL_FULL;
+    }
+#endif
+#if defined(CONFIG_LED_SHOW_FADE)
+    if (frame->flags & FRAME_FLAG_BLEND) {
+        size_t words = led_frame_words();
+
+        for (size_t w = 0; w < words; w++) {
+            shown.words[w] = frame->frame.words[w] | frame->frame2.words[w];
+        }
+        leds = &shown;
+        level = MAX(frame->level, frame->level2);
+    }
+#endif
+
+    frame_trace_record(leds, level);
+    frame_vcd_record(leds, level);
+}
+
+/**
+ * @brief Track the drift of the output from the show timeline
+ *
+ * The cycle count is accumulated frame by frame, so it only has to not
+ * wrap between two frames.
+ */
+static void output_drift(const struct led_qframe *frame)
+{
+    uint32_t cycles = k_cycle_get_32();
+    k_ticks_t show_ticks;
+
+    if (!anchored) {
+        anchored = true;
+        anchor_deadline = frame->deadline;
+        last_cycles = cycles;
+        elapsed_cycles = 0;
+    }
+
+    elapsed_cycles += cycles - last_cycles;
+    last_cycles = cycles;
+    show_ticks = frame->deadline - anchor_deadline;
+
+    stats.drift_us = (int32_t)((int64_t)k_cyc_to_us_floor64(elapsed_cycles) -
+                               (int64_t)k_ticks_to_us_floor64(show_ticks));
+
+    if (frame->flags & FRAME_FLAG_END) {
+        /* Stopped: the next frame starts a new timeline */
+        anchored = false;
+    }
+}
+
+/**
+ * @brief Put one frame on the LEDs and account for its timing
+ */
+static void output_commit(const struct led_qframe *frame, k_ticks_t now)
+{
+    k_ticks_t late = now - frame->deadline;
+
+    frame_stats_frame_start();
+    output_apply(frame);
+    frame_stats_record(frame->source, (int32_t)k_ticks_to_us_floor64(late));
+    output_record(frame);
+    if (frame->flags & FRAME_FLAG_LOOP) {
+        frame_trace_loop_end();
+    }
+
+    stats.committed++;
+    stats.late_us = (int32_t)k_ticks_to_us_floor64(late);
+    output_drift(frame);
+    if (late > 0) {
+        stats.late++;
+    }
+    if (late > max_late) {
+        max_late = late;
+        stats.max_late_us = (uint32_t)k_ticks_to_us_floor64(late);
+    }
+
+    if (frame->flags & FRAME_FLAG_MARK) {
+        uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - frame->stamp);
+
+        stats.switch_last_us = us;
+        if (us > stats.switch_max_us) {
+            stats.switch_max_us = us;
+        }
+    }
+}
+
+/**
+ * @brief Commit every due frame, re-arm the output timer for the next
+ */
+static void output_run(void)
+{
+    bool committed = false;
+    bool ended = false;
+
+    for (;;) {
+        atomic_val_t h = atomic_get(&head);
+        struct led_qframe *frame;
+        k_ticks_t now;
+
+        if (h == atomic_get(&tail)) {
+            /* Ring empty: go idle, then close the race with the producer */
+            atomic_clear(&armed);
+            if (h != atomic_get(&tail) && atomic_cas(&armed, 0, 1)) {
+                continue;
+            }
+            if (committed && !ended) {
+                stats.underruns++;
+            }
+            break;
+        }
+
+        frame = &ring[h & RING_MASK];
+
+        if (frame->epoch != (uint8_t)atomic_get(&epoch)) {
+            stats.dropped++;
+            atomic_set(&head, h + 1);
+            continue;
+        }
+
+        now = k_uptime_ticks();
+        if (frame->deadline > now) {
+            k_timer_start(&output_timer,
+                          K_TIMEOUT_ABS_TICKS(frame->deadline), K_NO_WAIT);
+            break;
+        }
+
+        output_commit(frame, now);
+        committed = true;
+        ended = (frame->flags & FRAME_FLAG_END) != 0;
+        atomic_set(&head, h + 1);
+    }
+
+    if (refill_cb != NULL &&
+        (atomic_get(&tail) - atomic_get(&head)) <= RING_SIZE / 2) {
+        refill_cb(refill_data);
+    }
+}
+
+/**
+ * @brief Output timer ISR: a deadline is due, wake the output thread
+ */
+static void output_expiry(struct k_timer *timer)
+{
+    ARG_UNUSED(timer);
+
+    k_sem_give(&output_sem);
+}
+
+static void output_thread(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    for (;;) {
+        k_sem_take(&output_sem, K_FOREVER);
+        output_run();
+    }
+}
+
+K_THREAD_DEFINE(led_output_tid, CONFIG_LED_SHOW_OUTPUT_STACK_SIZE,
+                output_thread, NULL, NULL, NULL,
+                CONFIG_LED_SHOW_OUTPUT_PRIORITY, 0, 0);
+
+/* ============================================================================
+ * API
+ * ============================================================================
+ */
+
+void frame_queue_init(frame_queue_refill_t refill, void *user_data)
+{
+    refill_cb = refill;
+    refill_data = user_data;
+
+    frame_stats_init();
+    frame_vcd_init();
+}
+
+struct led_qframe *frame_queue_acquire(void)
+{
+    atomic_val_t t = atomic_get(&tail);
+
+    if (t - atomic_get(&head) >= RING_SIZE) {
+        return NULL;
+    }
+
+    return &ring[t & RING_MASK];
+}
+
+void frame_queue_produce(void)
+{
+    atomic_val_t t = atomic_get(&tail);
+    uint32_t depth;
+
+    ring[t & RING_MASK].epoch = (uint8_t)atomic_get(&epoch);
+    atomic_set(&tail, t + 1);
+
+    depth = (uint32_t)(t + 1 - atomic_get(&head));
+    if (depth > stats.max_depth) {
+        stats.max_depth = depth;
+    }
+
+    /* Idle ring: this frame is the new head, start the output timer */
+    if (atomic_cas(&armed, 0, 1)) {
+        k_timer_start(&output_timer,
+                      K_TIMEOUT_ABS_TICKS(ring[t & RING_MASK].deadline),
+                      K_NO_WAIT);
+    }
+}
+
+void frame_queue_flush(void)
+{
+    atomic_inc(&epoch);
+    anchored = false;
+
+    /* Wake the output thread to drop the stale frames at once */
+    atomic_set(&armed, 1);
+    k_timer_start(&output_timer, K_NO_WAIT, K_NO_WAIT);
+}
+
+void frame_queue_get_stats(struct frame_queue_stats *out)
+{
+    *out = stats;
+    out->depth = (uint32_t)(atomic_get(&tail) - atomic_get(&head));
+}
@@ -0,0 +1,113 @@
+/*
+ * Frame Output Queue
+ *
+ * Description: Decouples rendering from output. The renderer fills a
+ *              lock-free single-producer/single-consumer ring with frames
+ *              stamped with their absolute deadline; a kernel timer wakes
+ *              a high-priority output thread that pops each frame and puts
+ *              it on the LEDs at that deadline, so render cost (printf,
+ *              complex effects) no longer shows up as output jitter.
+ *
+ * License:     MIT
+ */
+
+#ifndef FRAME_QUEUE_H_
+#define FRAME_QUEUE_H_
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+#include "led_frame.h"
+#include "led_layer.h"
+
+/* Flags of struct led_qframe */
+#define FRAME_FLAG_MARK   BIT(0) /* Record latency from @p stamp on commit */
+#define FRAME_FLAG_END    BIT(1) /* Last frame on purpose (show stopped) */
+#define FRAME_FLAG_LOOP   BIT(2) /* Last frame of a sequence loop */
+#define FRAME_FLAG_BLEND  BIT(3) /* Two layers: @p frame2 over @p frame */
+#define FRAME_FLAG_LEVELS BIT(4) /* Shown from @p levels over base @p frame */
+#define FRAME_FLAG_CUT    BIT(5) /* BLEND past halfway: @p frame2 wins */
+
+/**
+ * @brief A queued frame
+ */
+struct led_qframe {
+    k_ticks_t deadline;     /* Absolute tick the frame must appear at */
+    uint32_t stamp;         /* Cycle count of the request (MARK frames) */
+    struct led_frame frame; /* LEDs that are ON */
+    uint8_t level;          /* Brightness of the ON LEDs */
+    uint8_t epoch;          /* Flush generation, set by the queue */
+    uint8_t source;         /* Producer-defined origin, for frame_stats */
+    uint8_t flags;          /* FRAME_FLAG_* */
+#if defined(CONFIG_LED_SHOW_FADE)
+    uint8_t level2;         /* Brightness of @p frame2 (FRAME_FLAG_BLEND) */
+    struct led_frame frame2; /* Second layer (FRAME_FLAG_BLEND) */
+#endif
+#if defined(CONFIG_LED_SHOW_LEVELS)
+    struct led_levels levels; /* Composited levels (FRAME_FLAG_LEVELS) */
+#endif
+};
+
+/**
+ * @brief Output queue statistics
+ */
+struct frame_queue_stats {
+    uint32_t committed;     /* Frames put on the LEDs */
+    uint32_t late;          /* Frames committed after their deadline tick */
+    uint32_t underruns;     /* Times the ring ran dry while running */
+    uint32_t dropped;       /* Frames discarded by a flush */
+    uint32_t depth;         /* Frames queued right now */
+    uint32_t max_depth;     /* Most frames ever queued */
+    int32_t drift_us;       /* Time elapsed minus timeline time, since the
+                             * timeline was last anchored (start, flush) */
+    int32_t late_us;        /* Commit time minus deadline, last frame */
+    uint32_t max_late_us;   /* Worst commit lateness */
+    uint32_t switch_last_us; /* Request to commit of the last MARK frame */
+    uint32_t switch_max_us;  /* Worst request to commit of a MARK frame */
+};
+
+/**
+ * @brief Refill callback, called from the output thread
+ *
+ * Invoked when the ring drops to half full or less. Must not block,
+ * typically it reschedules the renderer's work item.
+ */
+typedef void (*frame_queue_refill_t)(void *user_data);
+
+/**
+ * @brief Set up the output queue
+ *
+ * @param refill    Called when the renderer should produce more frames
+ * @param user_data Passed to @p refill
+ */
+void frame_queue_init(frame_queue_refill_t refill, void *user_data);
+
+/**
+ * @brief Reserve the next free slot (renderer only)
+ *
+ * @return Slot to fill, or NULL if the ring is full
+ */
+struct led_qframe *frame_queue_acquire(void);
+
+/**
+ * @brief Publish the slot returned by frame_queue_acquire() (renderer only)
+ */
+void frame_queue_produce(void);
+
+/**
+ * @brief Discard all queued frames (renderer only)
+ *
+ * Frames produced afterwards are shown starting at their own deadline;
+ * the ones already queued are dropped by the output thread without being
+ * shown.
+ */
+void frame_queue_flush(void);
+
+/**
+ * @brief Read the output statistics
+ *
+ * @param stats Filled with the current figures
+ */
+void frame_queue_get_stats(struct frame_queue_stats *stats);
+
+#endif /* FRAME_QUEUE_H_ */
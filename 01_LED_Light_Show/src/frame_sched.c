@@ -0,0 +1,36 @@
+/*
+ * Frame Scheduler
+ *
+ * Description: Absolute deadlines expressed as K_TIMEOUT_ABS_TICKS(), usable
+ *              with k_sleep(), kernel timers and delayable work items alike.
+ *              Each frame adds duration x rate to the deadline; the part
+ *              below one tick is carried to the next frame.
+ *
+ * License:     MIT
+ */
+
+#include "frame_sched.h"
+
+void frame_sched_start(struct frame_sched *sched)
+{
+    frame_sched_resync(sched);
+}
+
+void frame_sched_resync(struct frame_sched *sched)
+{
+    sched->deadline = k_uptime_ticks();
+    sched->frac = 0;
+}
+
+k_timeout_t frame_sched_advance(struct frame_sched *sched,
+                                uint32_t duration_ms, uint64_t rate)
+{
+    /* Deadline moves on from the previous one, not from "now" */
+    uint64_t frac = sched->frac + (uint64_t)duration_ms * (uint32_t)rate;
+
+    sched->deadline += (k_ticks_t)duration_ms * (k_ticks_t)(rate >> 32) +
+                       (k_ticks_t)(frac >> 32);
+    sched->frac = (uint32_t)frac;
+
+    return K_TIMEOUT_ABS_TICKS(sched->deadline);
+}
@@ -0,0 +1,83 @@
+/*
+ * Frame Scheduler
+ *
+ * Description: Drift-free frame pacing. Every frame is scheduled against an
+ *              absolute kernel tick deadline derived from the nominal show
+ *              timeline, so time spent rendering, committing frames or
+ *              printing is absorbed instead of being added on top of each
+ *              delay.
+ *
+ * License:     MIT
+ */
+
+#ifndef FRAME_SCHED_H_
+#define FRAME_SCHED_H_
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+/* ============================================================================
+ * SCHEDULER STATE
+ * ============================================================================
+ */
+
+/**
+ * @brief One frame timeline
+ *
+ * The deadline is kept in ticks plus a 32-bit tick fraction (a phase
+ * accumulator), so frame durations that are not whole ticks, e.g. at a
+ * tempo of 128 BPM (led_tempo.h), never accumulate rounding errors.
+ */
+struct frame_sched {
+    k_ticks_t deadline;     /* Absolute tick of the next deadline */
+    uint32_t frac;          /* Fraction of a tick past the deadline */
+};
+
+/** Rate of a timeline running in real milliseconds, 32.32 ticks per ms */
+#define FRAME_SCHED_RATE_MS \
+    (((uint64_t)CONFIG_SYS_CLOCK_TICKS_PER_SEC << 32) / 1000U)
+
+/* ============================================================================
+ * API
+ * ============================================================================
+ */
+
+/**
+ * @brief Start a timeline at the current tick
+ *
+ * The first deadline is the current tick itself.
+ *
+ * @param sched Scheduler to (re)start
+ */
+void frame_sched_start(struct frame_sched *sched);
+
+/**
+ * @brief Re-anchor the timeline at the current tick
+ *
+ * Used when the show is deliberately interrupted (e.g. a button skips to
+ * another effect): the next deadline becomes "now" and the following ones
+ * are derived from it.
+ *
+ * @param sched Scheduler to re-anchor
+ */
+void frame_sched_resync(struct frame_sched *sched);
+
+/**
+ * @brief Advance the timeline to the next deadline
+ *
+ * The deadline is @p duration_ms after the previous deadline, not after
+ * the current time. The returned timeout is absolute and can be handed to
+ * k_sleep(), k_timer_start() or k_work_reschedule(); if the deadline
+ * already passed, it expires immediately.
+ *
+ * @param sched       Scheduler
+ * @param duration_ms Nominal duration of the frame at the current deadline
+ * @param rate        Ticks per nominal ms, 32.32 fixed point, e.g.
+ *                    led_tempo_ticks_per_ms() or FRAME_SCHED_RATE_MS
+ *
+ * @return Absolute timeout of the new deadline
+ */
+k_timeout_t frame_sched_advance(struct frame_sched *sched,
+                                uint32_t duration_ms, uint64_t rate);
+
+#endif /* FRAME_SCHED_H_ */
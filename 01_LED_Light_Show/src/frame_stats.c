@@ -0,0 +1,292 @@
+/*
+ * Frame Timing Statistics
+ *
+ * Description: Recording is a handful of integer operations in the output
+ *              thread: the bucket is the bit length of the lateness in us,
+ *              so the histogram covers 1 us to 16 ms with no division.
+ *              Percentiles are derived from the histogram when read.
+ *
+ *              The debug GPIO is the "debug-gpios" property of the
+ *              devicetree zephyr,user node; it toggles at every frame, so
+ *              each edge is one frame start.
+ *
+ * License:     MIT
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/logging/log.h>
+
+#include "frame_stats.h"
+
+LOG_MODULE_REGISTER(frame_stats, CONFIG_LED_SHOW_LOG_LEVEL);
+
+#if defined(CONFIG_LED_SHOW_STATS)
+
+#define STATS_SOURCES CONFIG_LED_SHOW_STATS_SOURCES
+
+/**
+ * @brief Figures of one source while being recorded
+ */
+struct stats_slot {
+    uint32_t frames;
+    uint32_t missed;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint32_t hist[FRAME_STATS_BUCKETS];
+};
+
+static struct k_spinlock lock;
+static struct stats_slot total;
+static struct stats_slot sources[STATS_SOURCES];
+static const char *names[STATS_SOURCES];
+
+#define USER_NODE DT_PATH(zephyr_user)
+
+#if DT_NODE_HAS_PROP(USER_NODE, debug_gpios)
+static const struct gpio_dt_spec debug_pin =
+    GPIO_DT_SPEC_GET(USER_NODE, debug_gpios);
+static bool debug_ready;
+#endif
+
+/* ============================================================================
+ * RECORDING
+ * ============================================================================
+ */
+
+static void slot_reset(struct stats_slot *slot)
+{
+    *slot = (struct stats_slot){ .min_us = UINT32_MAX };
+}
+
+static void slot_add(struct stats_slot *slot, uint32_t us, int bucket)
+{
+    slot->frames++;
+    slot->hist[bucket]++;
+    if (us > CONFIG_LED_SHOW_STATS_MISS_US) {
+        slot->missed++;
+    }
+    if (us < slot->min_us) {
+        slot->min_us = us;
+    }
+    if (us > slot->max_us) {
+        slot->max_us = us;
+    }
+}
+
+void frame_stats_frame_start(void)
+{
+#if DT_NODE_HAS_PROP(USER_NODE, debug_gpios)
+    if (debug_ready) {
+        gpio_pin_toggle_dt(&debug_pin);
+    }
+#endif
+}
+
+void frame_stats_record(int source, int32_t late_us)
+{
+    /* Early commits cannot happen; tick rounding is treated as on time */
+    uint32_t us = (late_us > 0) ? (uint32_t)late_us : 0;
+    int bucket = MIN((int)find_msb_set(us), FRAME_STATS_BUCKETS - 1);
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    slot_add(&total, us, bucket);
+    if (source >= 0 && source < STATS_SOURCES) {
+        slot_add(&sources[source], us, bucket);
+    }
+
+    k_spin_unlock(&lock, key);
+}
+
+/* ============================================================================
+ * REPORTING
+ * ============================================================================
+ */
+
+uint32_t frame_stats_bucket_max_us(int bucket)
+{
+    if (bucket >= FRAME_STATS_BUCKETS - 1) {
+        return UINT32_MAX;
+    }
+
+    return (uint32_t)BIT(bucket) - 1U;
+}
+
+/**
+ * @brief 99th percentile from a histogram, as a bucket upper bound
+ */
+static uint32_t slot_p99(const struct stats_slot *slot)
+{
+    uint32_t target = slot->frames - slot->frames / 100;
+    uint32_t seen = 0;
+
+    for (int b = 0; b < FRAME_STATS_BUCKETS; b++) {
+        seen += slot->hist[b];
+        if (seen >= target) {
+            return MIN(frame_stats_bucket_max_us(b), slot->max_us);
+        }
+    }
+
+    return slot->max_us;
+}
+
+void frame_stats_get(int source, struct frame_stats_summary *out)
+{
+    struct stats_slot snap;
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    if (source == FRAME_STATS_ALL) {
+        snap = total;
+    } else if (source >= 0 && source < STATS_SOURCES) {
+        snap = sources[source];
+    } else {
+        slot_reset(&snap);
+    }
+    k_spin_unlock(&lock, key);
+
+    out->frames = snap.frames;
+    out->missed = snap.missed;
+    out->min_us = snap.frames ? snap.min_us : 0;
+    out->max_us = snap.max_us;
+    out->p99_us = snap.frames ? slot_p99(&snap) : 0;
+    memcpy(out->hist, snap.hist, sizeof(out->hist));
+}
+
+void frame_stats_reset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    slot_reset(&total);
+    for (int i = 0; i < STATS_SOURCES; i++) {
+        slot_reset(&sources[i]);
+    }
+
+    k_spin_unlock(&lock, key);
+}
+
+int frame_stats_num_sources(void)
+{
+    return STATS_SOURCES;
+}
+
+void frame_stats_set_name(int source, const char *name)
+{
+    if (source >= 0 && source < STATS_SOURCES) {
+        names[source] = name;
+    }
+}
+
+const char *frame_stats_name(int source)
+{
+    return (source >= 0 && source < STATS_SOURCES) ? names[source] : NULL;
+}
+
+/* ============================================================================
+ * PERIODIC SUMMARY
+ * ============================================================================
+ */
+
+#if CONFIG_LED_SHOW_STATS_PERIOD_S > 0
+static void summary_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(summary_work, summary_handler);
+
+/**
+ * @brief Print the totals and the effect with the most missed deadlines
+ */
+static void summary_handler(struct k_work *work)
+{
+    struct frame_stats_summary all;
+    struct frame_stats_summary worst = { 0 };
+    int worst_src = -1;
+
+    frame_stats_get(FRAME_STATS_ALL, &all);
+
+    for (int i = 0; i < STATS_SOURCES; i++) {
+        struct frame_stats_summary s;
+
+        frame_stats_get(i, &s);
+        if (s.missed > worst.missed) {
+            worst = s;
+            worst_src = i;
+        }
+    }
+
+    LOG_INF("[TIMING] %u frames, lateness min %u / p99 %u / max %u us, "
+            "%u missed (most in %s: %u)", all.frames, all.min_us,
+            all.p99_us, all.max_us, all.missed,
+            (worst_src >= 0 && names[worst_src] != NULL) ?
+            names[worst_src] : "-", worst.missed);
+
+    k_work_reschedule(k_work_delayable_from_work(work),
+                      K_SECONDS(CONFIG_LED_SHOW_STATS_PERIOD_S));
+}
+#endif
+
+void frame_stats_init(void)
+{
+    frame_stats_reset();
+
+#if DT_NODE_HAS_PROP(USER_NODE, debug_gpios)
+    debug_ready = gpio_is_ready_dt(&debug_pin) &&
+                  gpio_pin_configure_dt(&debug_pin, GPIO_OUTPUT_INACTIVE) == 0;
+#endif
+
+#if CONFIG_LED_SHOW_STATS_PERIOD_S > 0
+    k_work_reschedule(&summary_work, K_SECONDS(CONFIG_LED_SHOW_STATS_PERIOD_S));
+#endif
+}
+
+#else /* !CONFIG_LED_SHOW_STATS */
+
+void frame_stats_init(void)
+{
+}
+
+void frame_stats_set_name(int source, const char *name)
+{
+    ARG_UNUSED(source);
+    ARG_UNUSED(name);
+}
+
+void frame_stats_frame_start(void)
+{
+}
+
+void frame_stats_record(int source, int32_t late_us)
+{
+    ARG_UNUSED(source);
+    ARG_UNUSED(late_us);
+}
+
+int frame_stats_num_sources(void)
+{
+    return 0;
+}
+
+const char *frame_stats_name(int source)
+{
+    ARG_UNUSED(source);
+
+    return NULL;
+}
+
+void frame_stats_get(int source, struct frame_stats_summary *out)
+{
+    ARG_UNUSED(source);
+
+    *out = (struct frame_stats_summary){ 0 };
+}
+
+void frame_stats_reset(void)
+{
+}
+
+uint32_t frame_stats_bucket_max_us(int bucket)
+{
+    ARG_UNUSED(bucket);
+
+    return 0;
+}
+
+#endif /* CONFIG_LED_SHOW_STATS */
@@ -0,0 +1,98 @@
+/*
+ * Frame Timing Statistics
+ *
+ * Description: Per-frame lateness (commit time minus deadline) collected
+ *              by the output thread: a fixed-bucket histogram with min, max
+ *              and p99, plus missed-deadline counts for every effect of
+ *              the show. Optionally toggles a debug GPIO at every frame
+ *              so the timing can be checked with a logic analyzer.
+ *
+ * License:     MIT
+ */
+
+#ifndef FRAME_STATS_H_
+#define FRAME_STATS_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Number of histogram buckets
+ *
+ * Bucket 0 counts frames committed on their deadline tick; bucket B
+ * (B >= 1) counts lateness from 2^(B-1) to 2^B - 1 us. The last bucket
+ * also takes everything later.
+ */
+#define FRAME_STATS_BUCKETS 16
+
+/** Source index for the figures of all sources together */
+#define FRAME_STATS_ALL -1
+
+/**
+ * @brief Timing figures of one source (effect) or of all frames
+ */
+struct frame_stats_summary {
+    uint32_t frames;        /* Frames committed */
+    uint32_t missed;        /* Frames later than the miss threshold */
+    uint32_t min_us;        /* Smallest lateness */
+    uint32_t max_us;        /* Largest lateness */
+    uint32_t p99_us;        /* 99th percentile (bucket upper bound) */
+    uint32_t hist[FRAME_STATS_BUCKETS];
+};
+
+/**
+ * @brief Configure the debug GPIO and start the periodic summary
+ */
+void frame_stats_init(void);
+
+/**
+ * @brief Name a source, for reports
+ *
+ * @param source Source index (show item), below frame_stats_num_sources()
+ * @param name   Effect name, must stay valid
+ */
+void frame_stats_set_name(int source, const char *name);
+
+/**
+ * @brief Mark the start of a frame on the debug GPIO (output thread)
+ */
+void frame_stats_frame_start(void);
+
+/**
+ * @brief Account for one committed frame (output thread)
+ *
+ * @param source  Source index the frame came from
+ * @param late_us Commit time minus deadline
+ */
+void frame_stats_record(int source, int32_t late_us);
+
+/**
+ * @brief Number of sources tracked separately
+ */
+int frame_stats_num_sources(void);
+
+/**
+ * @brief Name of a source, NULL if unnamed
+ */
+const char *frame_stats_name(int source);
+
+/**
+ * @brief Read the figures of a source
+ *
+ * @param source Source index, or FRAME_STATS_ALL
+ * @param out    Filled with a consistent snapshot
+ */
+void frame_stats_get(int source, struct frame_stats_summary *out);
+
+/**
+ * @brief Clear all figures
+ */
+void frame_stats_reset(void);
+
+/**
+ * @brief Largest lateness counted in a histogram bucket
+ *
+ * @return Upper bound in us, UINT32_MAX for the last bucket
+ */
+uint32_t frame_stats_bucket_max_us(int bucket);
+
+#endif /* FRAME_STATS_H_ */
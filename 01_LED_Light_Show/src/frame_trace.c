@@ -0,0 +1,195 @@
+/*
+ * Frame Trace
+ *
+ * Description: The output thread keeps a shadow of the last traced frame
+ *              and stores only the XOR of each changed word, so a frame
+ *              where nothing changed costs one pass over the words and no
+ *              entry. Times come from the kernel uptime, which on
+ *              native_sim is the simulated time: a --no-rt run gives the
+ *              same trace as a real-time one, only faster.
+ *
+ * License:     MIT
+ */
+
+#include <errno.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+#if defined(CONFIG_LED_SHOW_TRACE_EXIT)
+#include <posix_board_if.h>
+#endif
+
+#include "frame_trace.h"
+
+#if defined(CONFIG_LED_SHOW_TRACE)
+
+#define TRACE_DEPTH CONFIG_LED_SHOW_TRACE_DEPTH
+
+static struct k_spinlock lock;
+static struct frame_trace_entry entries[TRACE_DEPTH];
+static uint32_t count;
+static uint32_t dropped;
+
+/* Reference for the next frame; nothing traced yet while !started */
+static struct led_frame last;
+static uint8_t last_level;
+static bool started;
+static k_ticks_t start_ticks;
+
+/**
+ * @brief Store one entry, or count it if the trace is full
+ */
+static void trace_add(uint32_t t_us, uint16_t word, led_mask_t toggled,
+                      uint8_t level)
+{
+    if (count == TRACE_DEPTH) {
+        dropped++;
+        return;
+    }
+
+    entries[count++] = (struct frame_trace_entry){
+        .t_us = t_us,
+        .toggled = toggled,
+        .word = word,
+        .level = level,
+    };
+}
+
+void frame_trace_record(const struct led_frame *frame, uint8_t level)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    k_ticks_t now = k_uptime_ticks();
+    size_t words = led_frame_words();
+    bool changed = false;
+    uint32_t t_us;
+
+    if (!started) {
+        started = true;
+        start_ticks = now;
+        led_frame_clear(&last);
+        last_level = 0;
+    }
+    t_us = (uint32_t)k_ticks_to_us_floor64(now - start_ticks);
+
+    for (size_t w = 0; w < words; w++) {
+        led_mask_t delta = frame->words[w] ^ last.words[w];
+
+        if (delta != 0) {
+            trace_add(t_us, (uint16_t)w, delta, level);
+            last.words[w] = frame->words[w];
+            changed = true;
+        }
+    }
+
+    /* A brightness step without a pin change still shows */
+    if (!changed && level != last_level) {
+        trace_add(t_us, 0, 0, level);
+    }
+    last_level = level;
+
+    k_spin_unlock(&lock, key);
+}
+
+uint32_t frame_trace_count(void)
+{
+    return count;
+}
+
+uint32_t frame_trace_dropped(void)
+{
+    return dropped;
+}
+
+int frame_trace_get(uint32_t index, struct frame_trace_entry *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    int ret = -EINVAL;
+
+    if (index < count) {
+        *out = entries[index];
+        ret = 0;
+    }
+
+    k_spin_unlock(&lock, key);
+
+    return ret;
+}
+
+void frame_trace_clear(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    count = 0;
+    dropped = 0;
+    started = false;
+
+    k_spin_unlock(&lock, key);
+}
+
+#if defined(CONFIG_LED_SHOW_TRACE_EXIT)
+/**
+ * @brief Print the trace and end the native_sim program
+ *
+ * printk() rather than the deferred log: the program exits right after.
+ */
+static void trace_exit_handler(struct k_work *work)
+{
+    struct frame_trace_entry e;
+
+    ARG_UNUSED(work);
+
+    printk("TRACE,t_us,word,toggled,level\n");
+    for (uint32_t i = 0; frame_trace_get(i, &e) == 0; i++) {
+        printk("TRACE,%u,%u,0x%08x,%u\n", e.t_us, e.word, e.toggled,
+               e.level);
+    }
+    printk("TRACE,end,%u,%u\n", frame_trace_count(), frame_trace_dropped());
+
+    posix_exit(0);
+}
+
+static K_WORK_DEFINE(trace_exit_work, trace_exit_handler);
+#endif
+
+void frame_trace_loop_end(void)
+{
+#if defined(CONFIG_LED_SHOW_TRACE_EXIT)
+    k_work_submit(&trace_exit_work);
+#endif
+}
+
+#else /* !CONFIG_LED_SHOW_TRACE */
+
+void frame_trace_record(const struct led_frame *frame, uint8_t level)
+{
+    ARG_UNUSED(frame);
+    ARG_UNUSED(level);
+}
+
+void frame_trace_loop_end(void)
+{
+}
+
+uint32_t frame_trace_count(void)
+{
+    return 0;
+}
+
+uint32_t frame_trace_dropped(void)
+{
+    return 0;
+}
+
+int frame_trace_get(uint32_t index, struct frame_trace_entry *out)
+{
+    ARG_UNUSED(index);
+    ARG_UNUSED(out);
+
+    return -EINVAL;
+}
+
+void frame_trace_clear(void)
+{
+}
+
+#endif /* CONFIG_LED_SHOW_TRACE */
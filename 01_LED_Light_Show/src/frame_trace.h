@@ -0,0 +1,68 @@
+/*
+ * Frame Trace
+ *
+ * Description: Records the LED changes the output thread puts on the LEDs:
+ *              for every frame, each frame word whose bits flipped and
+ *              every brightness step, stamped with the time since the
+ *              first traced frame. Two runs of the show can then be
+ *              compared entry by entry, e.g. a native_sim run against an
+ *              earlier one.
+ *
+ * License:     MIT
+ */
+
+#ifndef FRAME_TRACE_H_
+#define FRAME_TRACE_H_
+
+#include <stdint.h>
+
+#include "led_frame.h"
+
+/**
+ * @brief One change on the LEDs
+ */
+struct frame_trace_entry {
+    uint32_t t_us;          /* Commit time since the first traced frame */
+    led_mask_t toggled;     /* LEDs of @p word that changed state */
+    uint16_t word;          /* Frame word (LEDs 32 * word to 32 * word + 31) */
+    uint8_t level;          /* Brightness of the ON LEDs */
+};
+
+/**
+ * @brief Trace a committed frame (output thread)
+ *
+ * @param frame LEDs that are ON
+ * @param level Brightness of the ON LEDs
+ */
+void frame_trace_record(const struct led_frame *frame, uint8_t level);
+
+/**
+ * @brief Mark the end of a sequence loop (output thread)
+ *
+ * With CONFIG_LED_SHOW_TRACE_EXIT, prints the trace and exits.
+ */
+void frame_trace_loop_end(void);
+
+/**
+ * @brief Number of stored entries
+ */
+uint32_t frame_trace_count(void);
+
+/**
+ * @brief Number of changes not stored because the trace was full
+ */
+uint32_t frame_trace_dropped(void);
+
+/**
+ * @brief Read a stored entry
+ *
+ * @return 0 on success, -EINVAL if @p index is not below frame_trace_count()
+ */
+int frame_trace_get(uint32_t index, struct frame_trace_entry *out);
+
+/**
+ * @brief Discard the trace; the next frame is traced at time 0
+ */
+void frame_trace_clear(void);
+
+#endif /* FRAME_TRACE_H_ */
@@ -0,0 +1,124 @@
+/*
+ * VCD Waveform Export
+ *
+ * Description: The embedded side keeps a shadow of the last frame and
+ *              passes only the LEDs that changed to the host side, which
+ *              formats them into a large stdio buffer. A frame without a
+ *              change costs one XOR per frame word, so tracing hardly
+ *              moves the timing it records.
+ *
+ * License:     MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "frame_vcd.h"
+
+#if defined(CONFIG_LED_SHOW_VCD)
+
+#include <cmdline.h>
+#include <posix_native_task.h>
+
+#include "frame_vcd_bottom.h"
+
+LOG_MODULE_REGISTER(frame_vcd, CONFIG_LED_SHOW_LOG_LEVEL);
+
+static char *vcd_path;          /* --vcd=<file>, NULL if not given */
+static bool vcd_open;
+static size_t vcd_leds;
+static struct led_frame last;
+static uint8_t last_level;
+
+static void vcd_add_options(void)
+{
+    static struct args_struct_t options[] = {
+        {
+            .option = "vcd",
+            .name = "file",
+            .type = 's',
+            .dest = (void *)&vcd_path,
+            .descript = "Write the LED outputs to this VCD file",
+        },
+        ARG_TABLE_ENDMARKER
+    };
+
+    native_add_command_line_opts(options);
+}
+
+NATIVE_TASK(vcd_add_options, PRE_BOOT_1, 1);
+
+static void vcd_close(void)
+{
+    if (vcd_open) {
+        vcd_open = false;
+        frame_vcd_bottom_close();
+    }
+}
+
+NATIVE_TASK(vcd_close, ON_EXIT_PRE, 1);
+
+void frame_vcd_init(void)
+{
+    if (vcd_path == NULL || vcd_open) {
+        return;
+    }
+
+    vcd_leds = led_frame_num_leds();
+    if (frame_vcd_bottom_open(vcd_path, (unsigned int)vcd_leds) < 0) {
+        LOG_ERR("Cannot create VCD file %s", vcd_path);
+        return;
+    }
+
+    led_frame_clear(&last);
+    last_level = 0;
+    vcd_open = true;
+    LOG_INF("Writing LED outputs to %s", vcd_path);
+}
+
+void frame_vcd_record(const struct led_frame *frame, uint8_t level)
+{
+    uint64_t t_ns;
+
+    if (!vcd_open) {
+        return;
+    }
+
+    t_ns = k_cyc_to_ns_floor64(k_cycle_get_64());
+
+    for (size_t w = 0; w * LED_FRAME_WORD_BITS < vcd_leds; w++) {
+        led_mask_t delta = frame->words[w] ^ last.words[w];
+
+        while (delta != 0) {
+            unsigned int bit = find_lsb_set(delta) - 1;
+            size_t led = w * LED_FRAME_WORD_BITS + bit;
+
+            if (led >= vcd_leds) {
+                break;
+            }
+            frame_vcd_bottom_led(t_ns, (unsigned int)led,
+                                 (frame->words[w] >> bit) & 1U);
+            delta &= delta - 1;
+        }
+        last.words[w] = frame->words[w];
+    }
+
+    if (level != last_level) {
+        frame_vcd_bottom_level(t_ns, level);
+        last_level = level;
+    }
+}
+
+#else /* !CONFIG_LED_SHOW_VCD */
+
+void frame_vcd_init(void)
+{
+}
+
+void frame_vcd_record(const struct led_frame *frame, uint8_t level)
+{
+    ARG_UNUSED(frame);
+    ARG_UNUSED(level);
+}
+
+#endif /* CONFIG_LED_SHOW_VCD */
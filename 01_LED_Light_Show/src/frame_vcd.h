@@ -0,0 +1,35 @@
+/*
+ * VCD Waveform Export
+ *
+ * Description: On native_sim, streams the LED outputs to a Value Change
+ *              Dump file given with --vcd=<file>, for a waveform viewer
+ *              such as GTKWave. Every LED of the set is its own 1-bit
+ *              signal, next to an 8-bit "level" signal for the brightness;
+ *              times are simulated nanoseconds.
+ *
+ * License:     MIT
+ */
+
+#ifndef FRAME_VCD_H_
+#define FRAME_VCD_H_
+
+#include <stdint.h>
+
+#include "led_frame.h"
+
+/**
+ * @brief Open the VCD file, if one was asked for on the command line
+ *
+ * Call once the LED set is known (after led_frame_init()).
+ */
+void frame_vcd_init(void);
+
+/**
+ * @brief Write the changes of a committed frame (output thread)
+ *
+ * @param frame LEDs that are ON
+ * @param level Brightness of the ON LEDs
+ */
+void frame_vcd_record(const struct led_frame *frame, uint8_t level);
+
+#endif /* FRAME_VCD_H_ */
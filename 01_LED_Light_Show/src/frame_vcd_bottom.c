@@ -0,0 +1,130 @@
+/*
+ * VCD Waveform Export, host side
+ *
+ * Description: Built into the native_sim runner with the host C library.
+ *              Output goes through a 256 KiB stdio buffer, so the file is
+ *              written in large blocks rather than once per change. A
+ *              time stamp is written only when it differs from the last.
+ *
+ * License:     MIT
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "frame_vcd_bottom.h"
+
+#define VCD_BUFFER_SIZE (256 * 1024)
+
+/* Identifier characters allowed by the VCD format */
+#define VCD_ID_FIRST '!'
+#define VCD_ID_COUNT ('~' - '!' + 1)
+
+static FILE *vcd;
+static char *vcd_buffer;
+static unsigned int vcd_leds;
+static uint64_t vcd_time;
+
+/**
+ * @brief Write the identifier of signal @p index (the level is last)
+ */
+static void vcd_put_id(unsigned int index)
+{
+    do {
+        fputc(VCD_ID_FIRST + (int)(index % VCD_ID_COUNT), vcd);
+        index /= VCD_ID_COUNT;
+    } while (index != 0);
+}
+
+static void vcd_put_time(uint64_t t_ns)
+{
+    if (t_ns != vcd_time) {
+        fprintf(vcd, "#%llu\n", (unsigned long long)t_ns);
+        vcd_time = t_ns;
+    }
+}
+
+static void vcd_put_level(unsigned int level)
+{
+    fputc('b', vcd);
+    for (int bit = 7; bit >= 0; bit--) {
+        fputc('0' + ((level >> bit) & 1U), vcd);
+    }
+    fputc(' ', vcd);
+    vcd_put_id(vcd_leds);
+    fputc('\n', vcd);
+}
+
+int frame_vcd_bottom_open(const char *path, unsigned int num_leds)
+{
+    vcd = fopen(path, "w");
+    if (vcd == NULL) {
+        return -1;
+    }
+
+    vcd_buffer = malloc(VCD_BUFFER_SIZE);
+    if (vcd_buffer != NULL) {
+        setvbuf(vcd, vcd_buffer, _IOFBF, VCD_BUFFER_SIZE);
+    }
+    vcd_leds = num_leds;
+    vcd_time = 0;
+
+    fprintf(vcd, "$version LED Light Show $end\n");
+    fprintf(vcd, "$timescale 1ns $end\n");
+    fprintf(vcd, "$scope module leds $end\n");
+    for (unsigned int i = 0; i < num_leds; i++) {
+        fprintf(vcd, "$var wire 1 ");
+        vcd_put_id(i);
+        fprintf(vcd, " led%u $end\n", i);
+    }
+    fprintf(vcd, "$var wire 8 ");
+    vcd_put_id(num_leds);
+    fprintf(vcd, " level $end\n");
+    fprintf(vcd, "$upscope $end\n$enddefinitions $end\n");
+
+    /* Everything off at time 0 */
+    fprintf(vcd, "#0\n$dumpvars\n");
+    for (unsigned int i = 0; i < num_leds; i++) {
+        fputc('0', vcd);
+        vcd_put_id(i);
+        fputc('\n', vcd);
+    }
+    vcd_put_level(0);
+    fprintf(vcd, "$end\n");
+
+    return 0;
+}
+
+void frame_vcd_bottom_led(uint64_t t_ns, unsigned int led, int value)
+{
+    if (vcd == NULL) {
+        return;
+    }
+
+    vcd_put_time(t_ns);
+    fputc(value ? '1' : '0', vcd);
+    vcd_put_id(led);
+    fputc('\n', vcd);
+}
+
+void frame_vcd_bottom_level(uint64_t t_ns, unsigned int level)
+{
+    if (vcd == NULL) {
+        return;
+    }
+
+    vcd_put_time(t_ns);
+    vcd_put_level(level);
+}
+
+void frame_vcd_bottom_close(void)
+{
+    if (vcd == NULL) {
+        return;
+    }
+
+    fclose(vcd);
+    vcd = NULL;
+    free(vcd_buffer);
+    vcd_buffer = NULL;
+}
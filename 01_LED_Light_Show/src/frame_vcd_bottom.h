@@ -0,0 +1,42 @@
+/*
+ * VCD Waveform Export, host side
+ *
+ * Description: Interface between the embedded side (frame_vcd.c) and the
+ *              native_sim host code that owns the file (frame_vcd_bottom.c).
+ *              Plain C types only: the two sides are built against
+ *              different C libraries.
+ *
+ * License:     MIT
+ */
+
+#ifndef FRAME_VCD_BOTTOM_H_
+#define FRAME_VCD_BOTTOM_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Create the file and write the header and the initial values
+ *
+ * @param path     File to write
+ * @param num_leds Number of LED signals, led0 to led<num_leds - 1>
+ *
+ * @return 0 on success, -1 if the file cannot be created
+ */
+int frame_vcd_bottom_open(const char *path, unsigned int num_leds);
+
+/**
+ * @brief Record a new value of one LED
+ */
+void frame_vcd_bottom_led(uint64_t t_ns, unsigned int led, int value);
+
+/**
+ * @brief Record a new brightness level
+ */
+void frame_vcd_bottom_level(uint64_t t_ns, unsigned int level);
+
+/**
+ * @brief Flush and close the file
+ */
+void frame_vcd_bottom_close(void);
+
+#endif /* FRAME_VCD_BOTTOM_H_ */
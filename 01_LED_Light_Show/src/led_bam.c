@@ -0,0 +1,198 @@
+/*
+ * Bit-Angle Modulation (BAM) Brightness Engine
+ *
+ * Description: Brightness levels are turned into 8 bit planes (plane B
+ *              holds the LEDs whose duty has bit B set). The timer ISR
+ *              commits plane B with the port-masked frame commit and
+ *              re-arms itself for 2^B time units, against an absolute
+ *              deadline so ISR latency does not stretch the period.
+ *
+ *              Planes are double buffered: levels are written to the
+ *              inactive set and the ISR swaps sets at the start of a
+ *              period, so a period is never shown half-updated.
+ *
+ * License:     MIT
+ */
+
+#include <errno.h>
+#include <zephyr/kernel.h>
+
+#include "led_bam.h"
+#include "led_frame.h"
+
+#if defined(CONFIG_LED_SHOW_BAM)
+
+#define BAM_BITS 8
+
+static struct led_frame planes[2][BAM_BITS];
+static uint8_t active;          /* Plane set shown by the ISR */
+static atomic_t pending;        /* Inactive set holds new levels */
+
+static void bam_expiry(struct k_timer *timer);
+static K_TIMER_DEFINE(bam_timer, bam_expiry, NULL);
+static k_ticks_t next_edge;     /* Absolute tick of the next plane switch */
+static uint8_t bit;             /* Plane currently being shown */
+
+/**
+ * @brief Perceptual mapping of an 8-bit level to a duty (gamma 2)
+ */
+static inline uint8_t level_to_duty(uint8_t level)
+{
+    return (uint8_t)(((uint16_t)level * level + 254) / 255);
+}
+
+/**
+ * @brief BAM timer ISR: show the next bit plane
+ */
+static void bam_expiry(struct k_timer *timer)
+{
+    if (bit == 0 && atomic_cas(&pending, 1, 0)) {
+        active ^= 1;
+    }
+
+    led_frame_commit(&planes[active][bit]);
+
+    next_edge += (k_ticks_t)CONFIG_LED_SHOW_BAM_LSB_TICKS << bit;
+    k_timer_start(timer, K_TIMEOUT_ABS_TICKS(next_edge), K_NO_WAIT);
+
+    bit = (bit + 1) % BAM_BITS;
+}
+
+/**
+ * @brief Get the inactive plane set for rewriting
+ *
+ * Clearing "pending" guarantees the ISR will not swap while the inactive
+ * set is rewritten: either it already swapped (and the inactive set is
+ * stale), or it will wait for the next bam_publish().
+ */
+static struct led_frame *bam_begin(void)
+{
+    atomic_cas(&pending, 1, 0);
+
+    return planes[active ^ 1];
+}
+
+/**
+ * @brief Hand the rewritten plane set to the ISR
+ */
+static void bam_publish(void)
+{
+    atomic_set(&pending, 1);
+}
+
+int led_bam_start(void)
+{
+    led_bam_set_levels(NULL, 0);
+
+    bit = 0;
+    next_edge = k_uptime_ticks() + 1;
+    k_timer_start(&bam_timer, K_TIMEOUT_ABS_TICKS(next_edge), K_NO_WAIT);
+
+    return 0;
+}
+
+void led_bam_stop(void)
+{
+    static const struct led_frame off;
+
+    k_timer_stop(&bam_timer);
+    led_frame_commit(&off);
+}
+
+void led_bam_set_levels(const uint8_t *levels, size_t count)
+{
+    struct led_frame *set = bam_begin();
+
+    for (int b = 0; b < BAM_BITS; b++) {
+        led_frame_clear(&set[b]);
+    }
+
+    for (size_t i = 0; i < count && i < LED_FRAME_MAX_LEDS; i++) {
+        uint8_t duty = level_to_duty(levels[i]);
+
+        for (int b = 0; b < BAM_BITS; b++) {
+            if (duty & BIT(b)) {
+                set[b].words[i / LED_FRAME_WORD_BITS] |=
+                    BIT(i % LED_FRAME_WORD_BITS);
+            }
+        }
+    }
+
+    bam_publish();
+}
+
+void led_bam_set_frame(const struct led_frame *frame, uint8_t level)
+{
+    struct led_frame *set = bam_begin();
+    uint8_t duty = level_to_duty(level);
+
+    /* All lit LEDs share one duty: each plane is the frame or nothing */
+    for (int b = 0; b < BAM_BITS; b++) {
+        if (duty & BIT(b)) {
+            led_frame_copy(&set[b], frame);
+        } else {
+            led_frame_clear(&set[b]);
+        }
+    }
+
+    bam_publish();
+}
+
+void led_bam_set_blend(const struct led_frame *a, uint8_t level_a,
+                       const struct led_frame *b, uint8_t level_b)
+{
+    struct led_frame *set = bam_begin();
+    uint8_t duty_a = level_to_duty(level_a);
+    uint8_t duty_b = level_to_duty(level_b);
+    uint8_t duty_ab = level_to_duty(led_frame_blend_level(level_a, level_b));
+    size_t words = led_frame_words();
+
+    /* Three duties: LEDs only in a, only in b, and in both */
+    for (size_t w = 0; w < words; w++) {
+        led_mask_t only_a = a->words[w] & ~b->words[w];
+        led_mask_t only_b = b->words[w] & ~a->words[w];
+        led_mask_t both = a->words[w] & b->words[w];
+
+        for (int p = 0; p < BAM_BITS; p++) {
+            set[p].words[w] = ((duty_a & BIT(p)) ? only_a : 0) |
+                              ((duty_b & BIT(p)) ? only_b : 0) |
+                              ((duty_ab & BIT(p)) ? both : 0);
+        }
+    }
+
+    bam_publish();
+}
+
+#else /* !CONFIG_LED_SHOW_BAM */
+
+int led_bam_start(void)
+{
+    return -ENOTSUP;
+}
+
+void led_bam_stop(void)
+{
+}
+
+void led_bam_set_levels(const uint8_t *levels, size_t count)
+{
+    ARG_UNUSED(levels);
+    ARG_UNUSED(count);
+}
+
+void led_bam_set_frame(const struct led_frame *frame, uint8_t level)
+{
+    ARG_UNUSED(frame);
+    ARG_UNUSED(level);
+}
+
+void led_bam_set_blend(const struct led_frame *a, uint8_t level_a,
+                       const struct led_frame *b, uint8_t level_b)
+{
+    ARG_UNUSED(a);
+    ARG_UNUSED(level_a);
+    ARG_UNUSED(b);
+    ARG_UNUSED(level_b);
+}
+
+#endif /* CONFIG_LED_SHOW_BAM */
@@ -0,0 +1,71 @@
+/*
+ * Bit-Angle Modulation (BAM) Brightness Engine
+ *
+ * Description: Per-LED 8-bit brightness on plain GPIO pins. A timer ISR
+ *              shows one bit plane per interrupt, each for a time
+ *              proportional to its bit weight, so a full period needs only
+ *              8 interrupts regardless of the number of LEDs.
+ *
+ * License:     MIT
+ */
+
+#ifndef LED_BAM_H_
+#define LED_BAM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "led_frame.h"
+
+/**
+ * @brief Start generating brightness on the GPIO LEDs
+ *
+ * While running, the BAM ISR owns the LEDs: do not commit frames from
+ * elsewhere until led_bam_stop() returns. All levels start at 0.
+ * Safe to call from an ISR.
+ *
+ * @return 0 on success, -ENOTSUP if BAM is disabled in Kconfig
+ */
+int led_bam_start(void);
+
+/**
+ * @brief Stop the BAM ISR and turn all LEDs off
+ *
+ * Safe to call from an ISR.
+ */
+void led_bam_stop(void);
+
+/**
+ * @brief Set the brightness of every LED
+ *
+ * @param levels Brightness per LED, 0 (off) to 255 (fully on)
+ * @param count  Number of entries in @p levels (extra LEDs are set to 0)
+ */
+void led_bam_set_levels(const uint8_t *levels, size_t count);
+
+/**
+ * @brief Set the LEDs of a frame to one brightness, all others off
+ *
+ * Equivalent to led_bam_set_levels() with @p level for every LED set in
+ * @p frame, but builds the bit planes a word at a time.
+ *
+ * @param frame LEDs to light
+ * @param level Brightness of the lit LEDs, 0 to 255
+ */
+void led_bam_set_frame(const struct led_frame *frame, uint8_t level);
+
+/**
+ * @brief Show two frames over each other, each at its own brightness
+ *
+ * LEDs lit in both get led_frame_blend_level(). Like led_bam_set_frame(),
+ * the bit planes are built a word at a time.
+ *
+ * @param a       First layer
+ * @param level_a Brightness of the LEDs of @p a
+ * @param b       Second layer
+ * @param level_b Brightness of the LEDs of @p b
+ */
+void led_bam_set_blend(const struct led_frame *a, uint8_t level_a,
+                       const struct led_frame *b, uint8_t level_b);
+
+#endif /* LED_BAM_H_ */
@@ -0,0 +1,198 @@
+/*
+ * LED Level Blending
+ *
+ * Description: Saturating add, max and the lit-LED select come down to one
+ *              or two DSP instructions per word: __UQADD8 adds four lanes
+ *              with saturation, __USUB8 sets the per-lane GE flags that
+ *              __SEL then uses to pick lanes. The SWAR fallback computes
+ *              the same lane masks from the top bit of every byte.
+ *
+ *              Mixing by a shared factor works on the even and odd lanes
+ *              as two 16-bit halves, so one multiply scales two LEDs.
+ *              The DSP extension has no 8-bit lane multiply, so the
+ *              multiply mode takes one multiply per LED on every target.
+ *
+ * License:     MIT
+ */
+
+#include <zephyr/sys/util.h>
+
+#include "led_blend.h"
+
+#if defined(CONFIG_LED_SHOW_BLEND_DSP)
+#include <cmsis_core.h>
+#endif
+
+#define LANES_LSB  0x01010101U     /* Bit 0 of every lane */
+#define LANES_MSB  0x80808080U     /* Bit 7 of every lane */
+#define LANES_EVEN 0x00FF00FFU     /* Lanes 0 and 2, as 16-bit halves */
+
+/* ============================================================================
+ * LANE OPERATIONS
+ * ============================================================================
+ * Four LED levels per call.
+ */
+
+#if defined(CONFIG_LED_SHOW_BLEND_DSP)
+
+static inline uint32_t blend_add4(uint32_t a, uint32_t b)
+{
+    return __UQADD8(a, b);
+}
+
+static inline uint32_t blend_max4(uint32_t a, uint32_t b)
+{
+    /* GE per lane where a >= b */
+    (void)__USUB8(a, b);
+
+    return __SEL(a, b);
+}
+
+/**
+ * @brief Lanes of @p a where @p lit is not 0, lanes of @p b elsewhere
+ */
+static inline uint32_t blend_lit4(uint32_t lit, uint32_t a, uint32_t b)
+{
+    (void)__USUB8(lit, LANES_LSB);
+
+    return __SEL(a, b);
+}
+
+#else /* !CONFIG_LED_SHOW_BLEND_DSP */
+
+/**
+ * @brief Expand bit 7 of every lane to the whole lane
+ */
+static inline uint32_t lanes_mask(uint32_t msb)
+{
+    /* 0 or 1 per lane times 0xFF: no carry into the next lane */
+    return (msb >> 7) * 0xFFU;
+}
+
+static inline uint32_t blend_add4(uint32_t a, uint32_t b)
+{
+    /* Add the low 7 bits, then bit 7 and its carry out by hand */
+    uint32_t low = (a & ~LANES_MSB) + (b & ~LANES_MSB);
+    uint32_t sum = low ^ ((a ^ b) & LANES_MSB);
+    uint32_t carry = ((a & b) | ((a | b) & low)) & LANES_MSB;
+
+    return sum | lanes_mask(carry);
+}
+
+static inline uint32_t blend_max4(uint32_t a, uint32_t b)
+{
+    /* Bit 7 of each lane of diff: low 7 bits of a >= those of b */
+    uint32_t diff = (a | LANES_MSB) - (b & ~LANES_MSB);
+    uint32_t ge = ((a & ~b) | (~(a ^ b) & diff)) & LANES_MSB;
+    uint32_t mask = lanes_mask(ge);
+
+    return (a & mask) | (b & ~mask);
+}
+
+/**
+ * @brief Lanes of @p a where @p lit is not 0, lanes of @p b elsewhere
+ */
+static inline uint32_t blend_lit4(uint32_t lit, uint32_t a, uint32_t b)
+{
+    uint32_t nonzero = (((lit & ~LANES_MSB) + ~LANES_MSB) | lit) & LANES_MSB;
+    uint32_t mask = lanes_mask(nonzero);
+
+    return (a & mask) | (b & ~mask);
+}
+
+#endif /* CONFIG_LED_SHOW_BLEND_DSP */
+
+/**
+ * @brief Lane-wise product, 255 * 255 = 255
+ */
+static inline uint32_t blend_mul4(uint32_t a, uint32_t b)
+{
+    uint32_t out = 0;
+
+    for (int shift = 0; shift < 32; shift += 8) {
+        uint32_t p = ((a >> shift) & 0xFFU) * ((b >> shift) & 0xFFU);
+
+        /* p / 255, rounded */
+        out |= ((p + 128 + ((p + 128) >> 8)) >> 8) << shift;
+    }
+
+    return out;
+}
+
+/**
+ * @brief Mix @p a towards @p b by @p mix / 256, two lanes per multiply
+ */
+static inline uint32_t blend_mix4(uint32_t a, uint32_t b, uint32_t mix)
+{
+    uint32_t even = ((a & LANES_EVEN) * (256 - mix) +
+                     (b & LANES_EVEN) * mix) >> 8;
+    uint32_t odd = ((a >> 8) & LANES_EVEN) * (256 - mix) +
+                   ((b >> 8) & LANES_EVEN) * mix;
+
+    return (even & LANES_EVEN) | (odd & ~LANES_EVEN);
+}
+
+/**
+ * @brief 0..255 to the 0..256 factor of blend_mix4()
+ */
+static inline uint32_t blend_factor(uint8_t value)
+{
+    return value + (value >> 7);
+}
+
+/* ============================================================================
+ * KERNELS
+ * ============================================================================
+ */
+
+/* One loop per mode, the mix only for layers that are not opaque */
+#define BLEND_LOOP(_expr)                                               \
+    do {                                                                \
+        for (size_t w = 0; w < words; w++) {                            \
+            uint32_t d = dst[w];                                        \
+            uint32_t s = src[w];                                        \
+                                                                        \
+            dst[w] = (mix == 256) ? (_expr)                             \
+                                  : blend_mix4(d, (_expr), mix);        \
+        }                                                               \
+    } while (0)
+
+void led_blend(enum led_blend_mode mode, uint32_t *dst, const uint32_t *src,
+               size_t words, uint8_t opacity)
+{
+    uint32_t mix = blend_factor(opacity);
+
+    if (mix == 0) {
+        return;
+    }
+
+    switch (mode) {
+    case LED_BLEND_ADD:
+        BLEND_LOOP(blend_add4(d, s));
+        break;
+    case LED_BLEND_MAX:
+        BLEND_LOOP(blend_max4(d, s));
+        break;
+    case LED_BLEND_MULTIPLY:
+        BLEND_LOOP(blend_mul4(d, s));
+        break;
+    case LED_BLEND_ALPHA:
+        BLEND_LOOP(blend_lit4(s, s, d));
+        break;
+    default:
+        break;
+    }
+}
+
+void led_blend_scale(uint32_t *dst, size_t words, uint8_t level)
+{
+    uint32_t mix = blend_factor(level);
+
+    if (mix == 256) {
+        return;
+    }
+
+    for (size_t w = 0; w < words; w++) {
+        dst[w] = blend_mix4(0, dst[w], mix);
+    }
+}
@@ -0,0 +1,65 @@
+/*
+ * LED Level Blending
+ *
+ * Description: Blend kernels for 8-bit LED levels packed four to a 32-bit
+ *              word: LED N is byte N % 4 of word N / 4, which on the
+ *              little-endian targets of this project is also a plain
+ *              uint8_t array. Every kernel works on whole words, so four
+ *              LEDs are blended per operation.
+ *
+ *              With CONFIG_LED_SHOW_BLEND_DSP the kernels use the SIMD
+ *              instructions of the Cortex-M33 DSP extension (__UQADD8,
+ *              __USUB8 and __SEL); elsewhere, e.g. on native_sim, portable
+ *              SWAR code gives the same results.
+ *
+ * License:     MIT
+ */
+
+#ifndef LED_BLEND_H_
+#define LED_BLEND_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* LED levels per word */
+#define LED_BLEND_LANES 4
+
+/** Opacity of a layer shown as it is */
+#define LED_BLEND_OPAQUE 255
+
+/**
+ * @brief How a layer combines with the levels under it
+ */
+enum led_blend_mode {
+    LED_BLEND_ADD,          /* Saturating sum: overlays that light up */
+    LED_BLEND_MAX,          /* Brighter of the two */
+    LED_BLEND_MULTIPLY,     /* Product, 255 = 1.0: envelopes; unlit = off */
+    LED_BLEND_ALPHA,        /* Lit LEDs of the layer replace the levels */
+    LED_BLEND_MODE_COUNT,
+};
+
+/**
+ * @brief Blend a layer into a level buffer
+ *
+ * @p dst = @p dst mixed with blend(@p dst, @p src) by @p opacity, so a
+ * layer at LED_BLEND_OPAQUE is applied in full and one at 0 not at all.
+ *
+ * @param mode    Blend mode
+ * @param dst     Levels under the layer, updated in place
+ * @param src     Levels of the layer
+ * @param words   Words in @p dst and @p src (LEDs / LED_BLEND_LANES)
+ * @param opacity Mix of the blended result, 0 to LED_BLEND_OPAQUE
+ */
+void led_blend(enum led_blend_mode mode, uint32_t *dst, const uint32_t *src,
+               size_t words, uint8_t opacity);
+
+/**
+ * @brief Scale every level by @p level / 255
+ *
+ * @param dst   Levels, updated in place
+ * @param words Words in @p dst
+ * @param level Scale, 255 leaves the levels unchanged
+ */
+void led_blend_scale(uint32_t *dst, size_t words, uint8_t level);
+
+#endif /* LED_BLEND_H_ */
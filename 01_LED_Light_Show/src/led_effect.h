@@ -0,0 +1,145 @@
+/*
+ * LED Effect Interface
+ *
+ * Description: Effects are resumable step functions. Each call produces
+ *              exactly one frame and how long it stays up; all progress is
+ *              kept in a few bytes of caller-owned state, so an effect
+ *              never blocks and any number of them can share one thread.
+ *
+ *              Effects can also give their frames as a pure function of
+ *              time (led_effect_eval_t). Such effects keep no state at
+ *              all, so the show can drop frames, sample them at any rate
+ *              or change tempo mid-cycle without the effect noticing.
+ *
+ * License:     MIT
+ */
+
+#ifndef LED_EFFECT_H_
+#define LED_EFFECT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/sys/iterable_sections.h>
+
+#include "led_frame.h"
+#include "led_output.h"
+
+/**
+ * @brief Registers of the bytecode VM (led_vm.h)
+ */
+struct led_vm_regs {
+    uint8_t pc;         /* Next opcode */
+    uint8_t mask;       /* 4-LED group mask of the frame */
+    uint8_t tick_ms;    /* Tick length (TEMPO), 0 = LED_VM_TICK_MS */
+    uint8_t loop_pc;    /* First opcode of the LOOP body */
+    uint8_t loop_left;  /* LOOP iterations left, this one included */
+    uint8_t fade_step;  /* Step of the running FADE */
+    uint8_t flags;      /* LED_VM_F_* */
+    uint8_t reserved;
+};
+
+/**
+ * @brief Progress of one running effect
+ *
+ * Zeroed when the effect starts. The meaning of @p aux is effect-private.
+ * @p vm is only used by bytecode effects; an effect run by the VM's CALL
+ * opcode shares the state and keeps to the fields before it.
+ */
+struct effect_state {
+    uint16_t frame;     /* Position within the current cycle */
+    uint8_t aux;        /* Effect-private (LFSR value, ...) */
+    uint8_t reserved;
+    struct led_vm_regs vm; /* Bytecode VM registers */
+};
+
+/**
+ * @brief One frame produced by a step function
+ *
+ * @p frame points at the buffer to render into (usually an output queue
+ * slot), so effects write the frame in place a word at a time.
+ */
+struct led_step {
+    struct led_frame *frame; /* LEDs that are ON, filled by the effect */
+    uint8_t level;          /* Brightness of the ON LEDs (LED_LEVEL_FULL) */
+    uint16_t duration_ms;   /* How long the frame is shown */
+};
+
+struct led_effect;
+
+/**
+ * @brief Produce the next frame of an effect
+ *
+ * @param effect Effect descriptor (for effect data such as frame tables)
+ * @param state  Progress, advanced by the call
+ * @param out    Next frame; out->frame is set by the caller
+ *
+ * @return true if @p out is the last frame of a cycle
+ */
+typedef bool (*led_effect_step_t)(const struct led_effect *effect,
+                                  struct effect_state *state,
+                                  struct led_step *out);
+
+/**
+ * @brief Compute the frame of an effect at a point in time
+ *
+ * Pure: the result only depends on @p effect and @p t_ms, so the caller
+ * may skip ahead, go back or sample at any rate.
+ *
+ * @param effect Effect descriptor
+ * @param t_ms   Time since the effect started
+ * @param out    Frame at @p t_ms; out->frame is set by the caller and
+ *               out->duration_ms receives the time from @p t_ms until
+ *               the frame next changes (at least 1)
+ *
+ * @return Length of one cycle in ms, the same for every call; 0 makes the
+ *         effect unplayable (led_playlist_validate() rejects it)
+ */
+typedef uint32_t (*led_effect_eval_t)(const struct led_effect *effect,
+                                      uint32_t t_ms, struct led_step *out);
+
+/**
+ * @brief Effect descriptor (const, lives in flash)
+ */
+struct led_effect {
+    const char *name;           /* Printed when the effect starts */
+    led_effect_step_t step;     /* Frame generator */
+    led_effect_eval_t eval;     /* Frame as a function of time, or NULL */
+    const void *data;           /* Effect-specific constant data */
+    uint8_t id;                 /* Registry id, see effects.h */
+    uint16_t cycles;            /* Default cycles per show entry */
+};
+
+/**
+ * @brief Define and register an effect
+ *
+ * The descriptor is placed in the led_effect iterable section, where
+ * led_effect_get() finds it by @p _id.
+ *
+ * @param _var    Variable name of the resulting struct led_effect
+ * @param _id     Registry id (enum led_effect_id)
+ * @param _name   Human readable name
+ * @param _step   Step function
+ * @param _data   Effect-specific constant data, or NULL
+ * @param _cycles Default cycles per show entry
+ */
+#define LED_EFFECT_DEFINE(_var, _id, _name, _step, _data, _cycles)     \
+    LED_EFFECT_DEFINE_EVAL(_var, _id, _name, _step, NULL, _data, _cycles)
+
+/**
+ * @brief Define and register an effect that can also be evaluated by time
+ *
+ * As LED_EFFECT_DEFINE(), with @p _eval giving the same frames as
+ * @p _step as a function of time (led_effect_eval_t).
+ */
+#define LED_EFFECT_DEFINE_EVAL(_var, _id, _name, _step, _eval, _data,   \
+                               _cycles)                                 \
+    const STRUCT_SECTION_ITERABLE(led_effect, _var) = {                 \
+        .name = (_name),                                                \
+        .step = (_step),                                                \
+        .eval = (_eval),                                                \
+        .data = (_data),                                                \
+        .id = (_id),                                                    \
+        .cycles = (_cycles),                                            \
+    }
+
+#endif /* LED_EFFECT_H_ */
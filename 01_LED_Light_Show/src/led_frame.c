@@ -0,0 +1,321 @@
+/*
+ * LED Frame Commit Layer
+ *
+ * Description: Per-port batching of LED updates. Instead of one
+ *              gpio_pin_set_dt() call per LED, the LED set is grouped by
+ *              GPIO port once at init, and each frame is then written with
+ *              one call per port.
+ *
+ *              A shadow copy of the frame on the pins is kept. Only the
+ *              LEDs whose state differs from it are touched: the XOR delta
+ *              is turned into per-port write masks, ports without changes
+ *              are not written at all, and a frame equal to the shadow
+ *              costs no driver call. Frames are scanned a word (32 LEDs)
+ *              at a time, so unchanged stretches of a large LED set cost
+ *              one compare per word.
+ *
+ * License:     MIT
+ */
+
+#include <errno.h>
+#include "led_frame.h"
+
+/* ============================================================================
+ * PORT GROUPS
+ * ============================================================================
+ * Precomputed at init so that a commit only has to OR pin bits together.
+ */
+
+/**
+ * @brief All LED pins that live on one GPIO port
+ */
+struct led_port_group {
+    const struct device *port;  /* GPIO controller */
+    gpio_port_pins_t pins;      /* Pins owned by LEDs on this port */
+    gpio_port_pins_t invert;    /* Subset of pins that are active-low */
+};
+
+static struct led_port_group groups[LED_FRAME_MAX_PORTS];
+static size_t num_groups;
+static bool bus_ports;          /* A group is an I2C or SPI expander */
+
+/* Per-LED lookup: which group it belongs to and its pin in that group */
+static uint8_t led_group[LED_FRAME_MAX_LEDS];
+static uint8_t led_pin[LED_FRAME_MAX_LEDS];
+static size_t num_leds;
+static size_t num_words;        /* Frame words holding at least one LED */
+static led_mask_t last_valid;   /* LEDs that exist in the last word */
+static size_t reserved_words;   /* Frame words read by other outputs */
+static size_t active_words = 1; /* led_frame_words() */
+
+/* Frame currently on the pins; only trusted once "shadow_valid" is set */
+static struct led_frame shadow;
+static bool shadow_valid;
+
+static struct led_frame_stats stats;
+
+/**
+ * @brief Word @p w of a frame with the bits past the last LED cleared
+ */
+static inline led_mask_t frame_word(const struct led_frame *frame, size_t w)
+{
+    return (w == num_words - 1) ? (frame->words[w] & last_valid)
+                                : frame->words[w];
+}
+
+/* ============================================================================
+ * BUS PORTS
+ * ============================================================================
+ * The GPIO controllers of the devicetree LEDs and whether they sit on an
+ * I2C or SPI bus. Their drivers block, so such ports are never written
+ * from an ISR (see led_frame_isr_safe()).
+ */
+#define LED_CTLR(node_id) DT_GPIO_CTLR(node_id, gpios)
+
+#define LED_PORT_BUS(node_id)                                   \
+    { DEVICE_DT_GET(LED_CTLR(node_id)),                         \
+      DT_ON_BUS(LED_CTLR(node_id), i2c) ||                      \
+      DT_ON_BUS(LED_CTLR(node_id), spi) },
+
+static const struct {
+    const struct device *port;
+    bool on_bus;
+} led_port_bus[] = {
+#if DT_NODE_EXISTS(LED_FRAME_LEDS_NODE)
+    DT_FOREACH_CHILD_STATUS_OKAY(LED_FRAME_LEDS_NODE, LED_PORT_BUS)
+#endif
+};
+
+/**
+ * @brief Whether @p port is a GPIO expander on I2C or SPI
+ */
+static bool port_on_bus(const struct device *port)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(led_port_bus); i++) {
+        if (led_port_bus[i].port == port) {
+            return led_port_bus[i].on_bus;
+        }
+    }
+
+    return false;
+}
+
+/* ============================================================================
+ * PORT WRITES
+ * ============================================================================
+ */
+
+/**
+ * @brief Add the pins of the LEDs set in @p bits to per-port pin masks
+ *
+ * @param pins Pin mask per port group, updated
+ * @param w    Frame word the bits come from
+ * @param bits LEDs of word @p w
+ */
+static void frame_word_to_pins(gpio_port_pins_t *pins, size_t w,
+                               led_mask_t bits)
+{
+    /* Visit set bits only */
+    while (bits != 0) {
+        size_t i = w * LED_FRAME_WORD_BITS + find_lsb_set(bits) - 1;
+
+        pins[led_group[i]] |= BIT(led_pin[i]);
+        bits &= bits - 1;
+    }
+}
+
+/**
+ * @brief Write a complete frame, ignoring the shadow
+ *
+ * Used for the first commit, so the shadow starts out matching the pins.
+ */
+static int frame_write_absolute(const struct led_frame *frame)
+{
+    gpio_port_value_t value[LED_FRAME_MAX_PORTS] = { 0 };
+    int ret;
+
+    /* Translate logical LED bits into physical pin bits per port */
+    for (size_t w = 0; w < num_words; w++) {
+        frame_word_to_pins(value, w, frame_word(frame, w));
+    }
+
+    /* One driver call per port; polarity is applied here, not per pin */
+    for (size_t g = 0; g < num_groups; g++) {
+        ret = gpio_port_set_masked_raw(groups[g].port, groups[g].pins,
+                                       value[g] ^ groups[g].invert);
+        if (ret < 0) {
+            return ret;
+        }
+        stats.port_writes++;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Write only the pins whose LED state differs from the shadow
+ *
+ * The changed pins are set to their new level with a masked write rather
+ * than flipped, so a pin the shadow got wrong is corrected instead of
+ * staying inverted. The cost is the same driver call per port.
+ *
+ * @param delta Changed pins per port group
+ * @param value LEDs now ON among them, per port group (before polarity)
+ */
+static int frame_write_delta(const gpio_port_pins_t *delta,
+                             const gpio_port_value_t *value)
+{
+    int ret;
+
+    for (size_t g = 0; g < num_groups; g++) {
+        if (delta[g] == 0) {
+            stats.port_writes_skipped++;
+            continue;
+        }
+        ret = gpio_port_set_masked_raw(groups[g].port, delta[g],
+                                       value[g] ^ groups[g].invert);
+        if (ret < 0) {
+            return ret;
+        }
+        stats.port_writes++;
+    }
+
+    return 0;
+}
+
+/* ============================================================================
+ * API
+ * ============================================================================
+ */
+
+int led_frame_init(const struct gpio_dt_spec *specs, size_t count)
+{
+    if (count == 0 || count > LED_FRAME_MAX_LEDS) {
+        return -EINVAL;
+    }
+
+    num_groups = 0;
+    bus_ports = false;
+
+    for (size_t i = 0; i < count; i++) {
+        size_t g;
+
+        /* Find the group for this port, or open a new one */
+        for (g = 0; g < num_groups; g++) {
+            if (groups[g].port == specs[i].port) {
+                break;
+            }
+        }
+        if (g == num_groups) {
+            if (num_groups == LED_FRAME_MAX_PORTS) {
+                return -ENOSPC;
+            }
+            groups[g].port = specs[i].port;
+            groups[g].pins = 0;
+            groups[g].invert = 0;
+            num_groups++;
+            bus_ports = bus_ports || port_on_bus(specs[i].port);
+        }
+
+        led_group[i] = (uint8_t)g;
+        led_pin[i] = (uint8_t)specs[i].pin;
+        groups[g].pins |= BIT(specs[i].pin);
+        if (specs[i].dt_flags & GPIO_ACTIVE_LOW) {
+            groups[g].invert |= BIT(specs[i].pin);
+        }
+    }
+
+    num_leds = count;
+    num_words = DIV_ROUND_UP(count, LED_FRAME_WORD_BITS);
+    last_valid = (count % LED_FRAME_WORD_BITS) ?
+                 (led_mask_t)(BIT(count % LED_FRAME_WORD_BITS) - 1U) :
+                 (led_mask_t)~0U;
+    active_words = MAX(MAX(num_words, reserved_words), 1);
+    shadow_valid = false;
+
+    return 0;
+}
+
+size_t led_frame_num_leds(void)
+{
+    return num_leds;
+}
+
+bool led_frame_isr_safe(void)
+{
+    return !bus_ports;
+}
+
+void led_frame_reserve(size_t count)
+{
+    count = MIN(count, LED_FRAME_MAX_LEDS);
+    reserved_words = MAX(reserved_words,
+                         DIV_ROUND_UP(count, LED_FRAME_WORD_BITS));
+    active_words = MAX(MAX(num_words, reserved_words), 1);
+}
+
+size_t led_frame_words(void)
+{
+    return active_words;
+}
+
+void led_frame_invalidate(void)
+{
+    shadow_valid = false;
+}
+
+int led_frame_commit(const struct led_frame *frame)
+{
+    gpio_port_pins_t delta_pins[LED_FRAME_MAX_PORTS] = { 0 };
+    gpio_port_value_t value[LED_FRAME_MAX_PORTS] = { 0 };
+    bool changed = false;
+    int ret;
+
+    stats.commits++;
+
+    if (!shadow_valid) {
+        ret = frame_write_absolute(frame);
+        if (ret < 0) {
+            return ret;
+        }
+        for (size_t w = 0; w < num_words; w++) {
+            shadow.words[w] = frame_word(frame, w);
+        }
+        shadow_valid = true;
+        return 0;
+    }
+
+    /* XOR against the shadow a word at a time; most words don't change */
+    for (size_t w = 0; w < num_words; w++) {
+        led_mask_t word = frame_word(frame, w);
+        led_mask_t delta = word ^ shadow.words[w];
+
+        if (delta != 0) {
+            stats.pins_changed += POPCOUNT(delta);
+            frame_word_to_pins(delta_pins, w, delta);
+            frame_word_to_pins(value, w, delta & word);
+            shadow.words[w] = word;
+            changed = true;
+        }
+    }
+
+    if (!changed) {
+        stats.frames_skipped++;
+        stats.port_writes_skipped += num_groups;
+        return 0;
+    }
+
+    ret = frame_write_delta(delta_pins, value);
+    if (ret < 0) {
+        /* Pins may be partially updated: rewrite everything next time */
+        shadow_valid = false;
+        return ret;
+    }
+
+    return 0;
+}
+
+void led_frame_get_stats(struct led_frame_stats *out)
+{
+    *out = stats;
+}
@@ -0,0 +1,219 @@
+/*
+ * LED Frame Commit Layer
+ *
+ * Description: Applies a complete LED frame (one bit per LED) to the
+ *              hardware with a single masked write per GPIO port.
+ *
+ * License:     MIT
+ */
+
+#ifndef LED_FRAME_H_
+#define LED_FRAME_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/sys/util.h>
+
+/* ============================================================================
+ * FRAME DEFINITIONS
+ * ============================================================================
+ */
+
+/** Maximum number of LEDs a single frame can address (one bit per LED) */
+#define LED_FRAME_MAX_LEDS   CONFIG_LED_SHOW_MAX_LEDS
+
+/** Maximum number of distinct GPIO ports the LEDs may be spread across */
+#define LED_FRAME_MAX_PORTS  CONFIG_LED_SHOW_MAX_PORTS
+
+/**
+ * Devicetree node whose children are the GPIO LEDs: the "led-show-leds"
+ * chosen node, or the first gpio-leds node when nothing is chosen
+ */
+#if DT_HAS_CHOSEN(led_show_leds)
+#define LED_FRAME_LEDS_NODE  DT_CHOSEN(led_show_leds)
+#else
+#define LED_FRAME_LEDS_NODE  DT_COMPAT_GET_ANY_STATUS_OKAY(gpio_leds)
+#endif
+
+/** LEDs per frame word */
+#define LED_FRAME_WORD_BITS  32
+
+/** Words in a frame buffer */
+#define LED_FRAME_WORDS \
+    DIV_ROUND_UP(LED_FRAME_MAX_LEDS, LED_FRAME_WORD_BITS)
+
+/**
+ * @brief One word of a frame: 32 LEDs
+ *
+ * Bit N set means LED N of the word is ON (active), regardless of the pin
+ * polarity.
+ */
+typedef uint32_t led_mask_t;
+
+/**
+ * @brief Bit-packed LED frame buffer
+ *
+ * LED N is bit N % 32 of word N / 32, the same layout as the bundles of
+ * a sys_bitarray. Effects work on whole words; bits past the last LED
+ * are ignored on commit.
+ */
+struct led_frame {
+    led_mask_t words[LED_FRAME_WORDS];
+};
+
+/**
+ * @brief Write counters of the frame commit layer
+ */
+struct led_frame_stats {
+    uint32_t commits;               /* Frames committed */
+    uint32_t frames_skipped;        /* Frames identical to the pins */
+    uint32_t port_writes;           /* GPIO port driver calls made */
+    uint32_t port_writes_skipped;   /* Port writes avoided by the shadow */
+    uint32_t pins_changed;          /* LEDs that actually changed state */
+};
+
+/* ============================================================================
+ * FRAME HELPERS
+ * ============================================================================
+ */
+
+/**
+ * @brief Level of an LED lit in both layers of a two-layer frame
+ *
+ * Two-layer frames (cross-fades) light the LEDs of each layer at that
+ * layer's level; where both are lit, the levels add up, saturating.
+ */
+static inline uint8_t led_frame_blend_level(uint8_t level_a, uint8_t level_b)
+{
+    return (uint8_t)MIN((uint32_t)level_a + level_b, 255U);
+}
+
+/**
+ * @brief Frame words in use
+ *
+ * Enough words for the GPIO LEDs and any output reserved with
+ * led_frame_reserve(), at least one. Words past this are never read, so
+ * effects and helpers only touch these.
+ */
+size_t led_frame_words(void);
+
+/**
+ * @brief Turn every LED of a frame off
+ */
+static inline void led_frame_clear(struct led_frame *frame)
+{
+    memset(frame->words, 0, led_frame_words() * sizeof(led_mask_t));
+}
+
+/**
+ * @brief Copy the words in use of a frame
+ */
+static inline void led_frame_copy(struct led_frame *dst,
+                                  const struct led_frame *src)
+{
+    memcpy(dst->words, src->words, led_frame_words() * sizeof(led_mask_t));
+}
+
+/**
+ * @brief Repeat one word pattern over the whole frame
+ *
+ * @param frame Frame to fill
+ * @param word  Pattern for every group of 32 LEDs
+ */
+static inline void led_frame_fill(struct led_frame *frame, led_mask_t word)
+{
+    size_t words = led_frame_words();
+
+    for (size_t w = 0; w < words; w++) {
+        frame->words[w] = word;
+    }
+}
+
+/**
+ * @brief Whether LED @p led is ON in a frame
+ */
+static inline bool led_frame_test(const struct led_frame *frame, size_t led)
+{
+    return (frame->words[led / LED_FRAME_WORD_BITS] &
+            BIT(led % LED_FRAME_WORD_BITS)) != 0;
+}
+
+/* ============================================================================
+ * API
+ * ============================================================================
+ */
+
+/**
+ * @brief Prepare the frame commit layer
+ *
+ * Groups the LED pins by GPIO port and precomputes, for every port,
+ * the mask of pins it owns and which of them are active-low. The pins
+ * must already be configured as outputs. The LEDs may come from any
+ * mix of SoC GPIO ports and GPIO expanders, as frames are committed
+ * from the output thread (see frame_queue.h). An expander on I2C or SPI
+ * cannot be written from an ISR, see led_frame_isr_safe().
+ *
+ * @param specs GPIO specifications, index N is LED N
+ * @param count Number of LEDs in @p specs
+ *
+ * @return 0 on success, -EINVAL or -ENOSPC if the LED set is too large
+ */
+int led_frame_init(const struct gpio_dt_spec *specs, size_t count);
+
+/**
+ * @brief Number of LEDs set up by led_frame_init()
+ */
+size_t led_frame_num_leds(void);
+
+/**
+ * @brief Whether the LED ports may be written from an ISR
+ *
+ * False when any LED set up by led_frame_init() sits on a GPIO expander
+ * on I2C or SPI, whose driver blocks. Interrupt driven outputs (BAM)
+ * must not be used then.
+ */
+bool led_frame_isr_safe(void);
+
+/**
+ * @brief Make frames cover at least @p count LEDs
+ *
+ * For outputs other than the GPIO LEDs (e.g. an LED strip) that read
+ * more of the frame than led_frame_init() set up.
+ *
+ * @param count LEDs the output reads, at most LED_FRAME_MAX_LEDS
+ */
+void led_frame_reserve(size_t count);
+
+/**
+ * @brief Apply a complete frame
+ *
+ * Only LEDs that differ from the previous frame are written: changed
+ * pins are set with one gpio_port_set_masked_raw() call per affected
+ * port, so a frame is never visible half-applied within a port. The first
+ * frame after init is written in full, every LED pin of each port.
+ *
+ * @param frame LED states, bit N = LED N
+ *
+ * @return 0 on success, negative error code from the GPIO driver
+ */
+int led_frame_commit(const struct led_frame *frame);
+
+/**
+ * @brief Forget what is on the pins
+ *
+ * For when something other than led_frame_commit() drove the LEDs (e.g.
+ * a PWM peripheral): the next frame is written in full, as after init.
+ */
+void led_frame_invalidate(void);
+
+/**
+ * @brief Read the write counters
+ *
+ * @param stats Filled with the current counters
+ */
+void led_frame_get_stats(struct led_frame_stats *stats);
+
+#endif /* LED_FRAME_H_ */
@@ -0,0 +1,127 @@
+/*
+ * LED Layer Compositor
+ *
+ * Description: Frames expand to levels four LEDs at a time, through a
+ *              table of byte masks indexed by four frame bits, and the
+ *              layers are then blended as whole level buffers by the
+ *              kernels of led_blend.c.
+ *
+ * License:     MIT
+ */
+
+#include <errno.h>
+
+#include "effects.h"
+#include "led_layer.h"
+
+/* Byte mask of four LEDs, indexed by their four frame bits */
+static const uint32_t expand[16] = {
+    0x00000000, 0x000000FF, 0x0000FF00, 0x0000FFFF,
+    0x00FF0000, 0x00FF00FF, 0x00FFFF00, 0x00FFFFFF,
+    0xFF000000, 0xFF0000FF, 0xFF00FF00, 0xFF00FFFF,
+    0xFFFF0000, 0xFFFF00FF, 0xFFFFFF00, 0xFFFFFFFF,
+};
+
+/* Levels words per frame word */
+#define LEVELS_PER_WORD (LED_FRAME_WORD_BITS / LED_BLEND_LANES)
+
+/* Scratch frame and levels of the layer being blended */
+static struct led_frame layer_frame;
+static struct led_levels layer_levels;
+
+/* ============================================================================
+ * LEVELS
+ * ============================================================================
+ */
+
+void led_levels_from_frame(struct led_levels *levels,
+                           const struct led_frame *frame, uint8_t level)
+{
+    uint32_t fill = level * 0x01010101U;
+    size_t words = led_frame_words();
+    uint32_t *out = levels->words;
+
+    for (size_t w = 0; w < words; w++) {
+        led_mask_t word = frame->words[w];
+
+        for (int n = 0; n < LEVELS_PER_WORD; n++) {
+            *out++ = expand[word & 0xFU] & fill;
+            word >>= LED_BLEND_LANES;
+        }
+    }
+}
+
+void led_levels_mask(struct led_levels *levels, const struct led_frame *mask)
+{
+    size_t words = led_frame_words();
+    uint32_t *out = levels->words;
+
+    for (size_t w = 0; w < words; w++) {
+        led_mask_t word = mask->words[w];
+
+        for (int n = 0; n < LEVELS_PER_WORD; n++) {
+            *out++ &= expand[word & 0xFU];
+            word >>= LED_BLEND_LANES;
+        }
+    }
+}
+
+void led_levels_to_frame(const struct led_levels *levels,
+                         struct led_frame *frame)
+{
+    size_t words = led_frame_words();
+    const uint32_t *in = levels->words;
+
+    for (size_t w = 0; w < words; w++) {
+        led_mask_t word = 0;
+
+        for (int n = 0; n < LEVELS_PER_WORD; n++) {
+            /* Bit 7 of the four lanes at bits 0, 8, 16, 24, gathered */
+            uint32_t msb = (*in++ >> 7) & 0x01010101U;
+
+            word |= (led_mask_t)(((msb * 0x00204081U) >> 21) & 0xFU)
+                    << (n * LED_BLEND_LANES);
+        }
+        frame->words[w] = word;
+    }
+}
+
+/* ============================================================================
+ * LAYERS
+ * ============================================================================
+ */
+
+int led_layers_validate(const struct led_layer *layers, size_t num)
+{
+    for (size_t i = 0; i < num; i++) {
+        const struct led_effect *effect = led_effect_get(layers[i].effect);
+
+        if (effect == NULL) {
+            return -ENOENT;
+        }
+        if (effect->eval == NULL || layers[i].mode >= LED_BLEND_MODE_COUNT) {
+            return -EINVAL;
+        }
+    }
+
+    return 0;
+}
+
+uint32_t led_layers_render(const struct led_layer *layers, size_t num,
+                           uint32_t t_ms, struct led_levels *levels)
+{
+    struct led_step step = { .frame = &layer_frame };
+    uint32_t next_ms = UINT32_MAX;
+
+    for (size_t i = 0; i < num; i++) {
+        const struct led_effect *effect = led_effect_get(layers[i].effect);
+
+        effect->eval(effect, t_ms, &step);
+        led_levels_from_frame(&layer_levels, &layer_frame, step.level);
+        led_blend(layers[i].mode, levels->words, layer_levels.words,
+                  led_levels_words(), layers[i].opacity);
+        next_ms = MIN(next_ms, step.duration_ms);
+    }
+
+    return MAX(next_ms, 1U);
+}
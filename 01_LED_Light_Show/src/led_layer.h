@@ -0,0 +1,117 @@
+/*
+ * LED Layer Compositor
+ *
+ * Description: Per-LED 8-bit levels and the layers composited into them.
+ *              A layer is an effect played by its time function (sparkle,
+ *              breathe, the frame tables) and blended over the levels
+ *              under it with a blend mode and an opacity (led_blend.h),
+ *              e.g. a sparkle overlay added over the show, or breathe
+ *              multiplied in as a brightness envelope.
+ *
+ * License:     MIT
+ */
+
+#ifndef LED_LAYER_H_
+#define LED_LAYER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "led_blend.h"
+#include "led_frame.h"
+
+/* ============================================================================
+ * LEVELS
+ * ============================================================================
+ */
+
+/** Words in a level buffer */
+#define LED_LEVELS_WORDS \
+    (LED_FRAME_WORDS * LED_FRAME_WORD_BITS / LED_BLEND_LANES)
+
+/**
+ * @brief Brightness of every LED, 0 to 255
+ *
+ * LED N is byte N % 4 of word N / 4 (led_blend.h), so the buffer is also
+ * an array of levels, see led_levels_bytes().
+ */
+struct led_levels {
+    uint32_t words[LED_LEVELS_WORDS];
+};
+
+/**
+ * @brief Words of the level buffers for the LEDs in use
+ *
+ * Covers the words of led_frame_words(), like the frame helpers.
+ */
+static inline size_t led_levels_words(void)
+{
+    return led_frame_words() * (LED_FRAME_WORD_BITS / LED_BLEND_LANES);
+}
+
+/**
+ * @brief The levels as an array, one byte per LED
+ */
+static inline const uint8_t *led_levels_bytes(const struct led_levels *levels)
+{
+    return (const uint8_t *)levels->words;
+}
+
+/**
+ * @brief Levels of a frame: its lit LEDs at @p level, the others off
+ */
+void led_levels_from_frame(struct led_levels *levels,
+                           const struct led_frame *frame, uint8_t level);
+
+/**
+ * @brief Turn off the levels of the LEDs not lit in @p mask
+ */
+void led_levels_mask(struct led_levels *levels, const struct led_frame *mask);
+
+/**
+ * @brief Frame of the LEDs at half brightness or more
+ *
+ * For outputs that can only switch LEDs on and off.
+ */
+void led_levels_to_frame(const struct led_levels *levels,
+                         struct led_frame *frame);
+
+/* ============================================================================
+ * LAYERS
+ * ============================================================================
+ */
+
+/**
+ * @brief One layer of a composition
+ */
+struct led_layer {
+    uint8_t effect;         /* Effect id, must have a time function */
+    uint8_t mode;           /* enum led_blend_mode */
+    uint8_t opacity;        /* 0 to LED_BLEND_OPAQUE */
+};
+
+/**
+ * @brief Check that layers can be composited
+ *
+ * @return 0 if valid, -ENOENT if an effect is not built into the image,
+ *         -EINVAL if an effect has no time function or a mode is unknown
+ */
+int led_layers_validate(const struct led_layer *layers, size_t num);
+
+/**
+ * @brief Composite layers over levels
+ *
+ * The layers are blended in order, the first one right over @p levels.
+ * Uses static scratch buffers: call from one thread only.
+ *
+ * @param layers Valid layers, see led_layers_validate()
+ * @param num    Number of @p layers
+ * @param t_ms   Time of the layers
+ * @param levels Levels under the layers, updated in place
+ *
+ * @return Time from @p t_ms until a layer next changes, at least 1
+ */
+uint32_t led_layers_render(const struct led_layer *layers, size_t num,
+                           uint32_t t_ms, struct led_levels *levels);
+
+#endif /* LED_LAYER_H_ */
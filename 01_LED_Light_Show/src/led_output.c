@@ -0,0 +1,209 @@
+/*
+ * LED Output Stage
+ *
+ * Description: Tracks which backend currently owns the LEDs and hands
+ *              over cleanly, e.g. stops the BAM ISR before the next plain
+ *              frame is committed.
+ *
+ * License:     MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "led_bam.h"
+#include "led_layer.h"
+#include "led_output.h"
+#include "led_pwm.h"
+#include "led_strip_out.h"
+
+LOG_MODULE_REGISTER(led_output, CONFIG_LED_SHOW_LOG_LEVEL);
+
+/**
+ * @brief Backend currently driving the LEDs
+ */
+enum led_output_mode {
+    OUTPUT_GPIO,    /* Plain frames through led_frame_commit() */
+    OUTPUT_PWM,     /* Hardware PWM levels */
+    OUTPUT_BAM,     /* Bit-angle modulation ISR */
+};
+
+static enum led_output_mode mode = OUTPUT_GPIO;
+static bool bam_usable;         /* BAM enabled and every LED ISR safe */
+static const struct led_frame frame_off;
+static atomic_t brightness = ATOMIC_INIT(LED_LEVEL_FULL);
+
+int led_output_init(void)
+{
+    /* The BAM ISR writes the ports, which I2C/SPI expanders can't take */
+    bam_usable = IS_ENABLED(CONFIG_LED_SHOW_BAM) && led_frame_isr_safe();
+
+    /* PWM brightness is optional: BAM or plain GPIO are used without it */
+    if (led_pwm_init() == 0) {
+        LOG_INF("PWM brightness enabled");
+    } else if (bam_usable) {
+        LOG_INF("No PWM LEDs, brightness uses BAM on GPIOs");
+    } else if (IS_ENABLED(CONFIG_LED_SHOW_BAM)) {
+        LOG_INF("No PWM LEDs, no BAM on bus GPIO expanders");
+    } else {
+        LOG_INF("No PWM LEDs, brightness not available");
+    }
+
+    if (led_strip_out_init() == 0) {
+        LOG_INF("LED strip output enabled");
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Whether the GPIO LEDs themselves can be dimmed
+ */
+static bool output_gpio_dimming(void)
+{
+    return led_pwm_available() || bam_usable;
+}
+
+bool led_output_has_dimming(void)
+{
+    return output_gpio_dimming() || led_strip_out_available();
+}
+
+/**
+ * @brief Release the LEDs from a dimming backend
+ *
+ * The PWM peripheral drove the pins behind the back of led_frame.c, so
+ * its shadow no longer matches them: the next commit writes them all.
+ */
+static void output_to_gpio(void)
+{
+    if (mode == OUTPUT_PWM) {
+        led_pwm_set(NULL, 0);
+        led_frame_invalidate();
+    } else if (mode == OUTPUT_BAM) {
+        led_bam_stop();
+    }
+    mode = OUTPUT_GPIO;
+}
+
+void led_output_set_brightness(uint8_t value)
+{
+    atomic_set(&brightness, value ? value : 1);
+}
+
+/**
+ * @brief Scale a frame level by the global brightness
+ */
+static uint8_t output_level(uint8_t level)
+{
+    if (!led_output_has_dimming()) {
+        return level;
+    }
+
+    return (uint8_t)((uint32_t)level *
+                     (uint32_t)atomic_get(&brightness) / LED_LEVEL_FULL);
+}
+
+/**
+ * @brief Hand the LEDs to the BAM ISR
+ */
+static void output_to_bam(void)
+{
+    if (mode != OUTPUT_BAM) {
+        led_bam_start();
+        mode = OUTPUT_BAM;
+    }
+}
+
+void led_output_apply(const struct led_frame *frame, uint8_t level)
+{
+    level = output_level(level);
+
+    /* Returns at once; the transfer runs in the strip thread */
+    led_strip_out_show(frame, level);
+
+    if (!output_gpio_dimming()) {
+        output_to_gpio();
+        led_frame_commit(level ? frame : &frame_off);
+        return;
+    }
+
+    if (level == LED_LEVEL_FULL) {
+        output_to_gpio();
+        led_frame_commit(frame);
+        return;
+    }
+
+    if (led_pwm_available()) {
+        mode = OUTPUT_PWM;
+        led_pwm_set(frame, level);
+        return;
+    }
+
+    output_to_bam();
+    led_bam_set_frame(frame, level);
+}
+
+void led_output_apply_blend(const struct led_frame *a, uint8_t level_a,
+                            const struct led_frame *b, uint8_t level_b,
+                            bool cut_to_b)
+{
+    level_a = output_level(level_a);
+    level_b = output_level(level_b);
+
+    led_strip_out_show_blend(a, level_a, b, level_b);
+
+    if (!output_gpio_dimming()) {
+        /* No dimming: hard cut halfway through the fade */
+        output_to_gpio();
+        if ((cut_to_b ? level_b : level_a) == 0) {
+            led_frame_commit(&frame_off);
+        } else {
+            led_frame_commit(cut_to_b ? b : a);
+        }
+        return;
+    }
+
+    if (led_pwm_available()) {
+        mode = OUTPUT_PWM;
+        led_pwm_set_blend(a, level_a, b, level_b);
+        return;
+    }
+
+    output_to_bam();
+    led_bam_set_blend(a, level_a, b, level_b);
+}
+
+#if defined(CONFIG_LED_SHOW_LEVELS)
+void led_output_apply_levels(const struct led_levels *levels)
+{
+    /* Brightness scaled copy; the output stage runs in one context */
+    static struct led_levels scaled;
+    static struct led_frame frame;
+    size_t words = led_levels_words();
+    size_t count = words * LED_BLEND_LANES;
+
+    memcpy(scaled.words, levels->words, words * sizeof(scaled.words[0]));
+    if (led_output_has_dimming()) {
+        led_blend_scale(scaled.words, words, (uint8_t)atomic_get(&brightness));
+    }
+
+    led_strip_out_show_levels(led_levels_bytes(&scaled), count);
+
+    if (!output_gpio_dimming()) {
+        output_to_gpio();
+        led_levels_to_frame(&scaled, &frame);
+        led_frame_commit(&frame);
+        return;
+    }
+
+    if (led_pwm_available()) {
+        mode = OUTPUT_PWM;
+        led_pwm_set_levels(led_levels_bytes(&scaled), count);
+        return;
+    }
+
+    output_to_bam();
+    led_bam_set_levels(led_levels_bytes(&scaled), count);
+}
+#endif
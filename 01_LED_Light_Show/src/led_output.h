@@ -0,0 +1,88 @@
+/*
+ * LED Output Stage
+ *
+ * Description: Single entry point that puts a frame on the LEDs. Plain
+ *              on/off frames go straight to the port-masked frame commit;
+ *              dimmed frames are routed to hardware PWM when the board has
+ *              PWM LEDs, or to the BAM ISR otherwise. Every frame is also
+ *              mirrored to an addressable LED strip when there is one.
+ *
+ * License:     MIT
+ */
+
+#ifndef LED_OUTPUT_H_
+#define LED_OUTPUT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "led_frame.h"
+
+/** Level meaning "plain on/off frame", no dimming */
+#define LED_LEVEL_FULL 255
+
+/**
+ * @brief Set up the brightness backends
+ *
+ * The GPIO LEDs and the frame commit layer must be initialized first.
+ *
+ * @return 0 (brightness backends are optional)
+ */
+int led_output_init(void);
+
+/**
+ * @brief Whether levels below LED_LEVEL_FULL are actually dimmed
+ *
+ * @return true if hardware PWM, BAM or an LED strip is available
+ */
+bool led_output_has_dimming(void);
+
+/**
+ * @brief Set the global brightness
+ *
+ * Scales the level of every frame shown from now on. Below
+ * LED_LEVEL_FULL, plain frames are routed through the dimming backend;
+ * without one the setting has no effect. Safe to call from an ISR.
+ *
+ * @param brightness 1 to LED_LEVEL_FULL (default)
+ */
+void led_output_set_brightness(uint8_t brightness);
+
+/**
+ * @brief Show a frame
+ *
+ * @param frame LEDs that are ON
+ * @param level Brightness of the ON LEDs; LED_LEVEL_FULL for a plain frame
+ */
+void led_output_apply(const struct led_frame *frame, uint8_t level);
+
+/**
+ * @brief Show two frames over each other, each at its own brightness
+ *
+ * Used for cross-fades. LEDs lit in both layers get
+ * led_frame_blend_level(). Without dimming, one layer is shown as a
+ * plain frame: @p b once @p cut_to_b is set, @p a before.
+ *
+ * @param a        First layer (outgoing)
+ * @param level_a  Brightness of the LEDs of @p a
+ * @param b        Second layer (incoming)
+ * @param level_b  Brightness of the LEDs of @p b
+ * @param cut_to_b Without dimming, show @p b (fade past halfway)
+ */
+void led_output_apply_blend(const struct led_frame *a, uint8_t level_a,
+                            const struct led_frame *b, uint8_t level_b,
+                            bool cut_to_b);
+
+struct led_levels;
+
+/**
+ * @brief Show every LED at its own brightness
+ *
+ * Used for composited layers (led_layer.h). Without dimming, the LEDs at
+ * half brightness or more are shown as a plain frame.
+ *
+ * @param levels Brightness per LED
+ */
+void led_output_apply_levels(const struct led_levels *levels);
+
+#endif /* LED_OUTPUT_H_ */
@@ -0,0 +1,86 @@
+/*
+ * LED Pattern Playback Engine
+ *
+ * Description: Table-driven playback. Per frame the only work left is a
+ *              table load and filling the frame with the pre-tiled word.
+ *              Evaluation by time walks the table instead, at most a
+ *              cycle's worth of entries.
+ *
+ * License:     MIT
+ */
+
+#include "led_pattern.h"
+
+bool led_pattern_step(const struct led_effect *effect,
+                      struct effect_state *state, struct led_step *out)
+{
+    const struct led_pattern *pattern = effect->data;
+    const struct led_pattern_frame *frame = &pattern->frames[state->frame];
+
+    led_frame_fill(out->frame, frame->mask);
+    out->level = LED_LEVEL_FULL;
+    out->duration_ms = frame->duration_ms;
+
+    if (++state->frame == pattern->num_frames) {
+        state->frame = 0;
+        return true;
+    }
+
+    return false;
+}
+
+uint32_t led_pattern_eval(const struct led_effect *effect, uint32_t t_ms,
+                          struct led_step *out)
+{
+    const struct led_pattern *pattern = effect->data;
+    const struct led_pattern_frame *frame = pattern->frames;
+    uint32_t period_ms = 0;
+
+    for (uint16_t i = 0; i < pattern->num_frames; i++) {
+        period_ms += pattern->frames[i].duration_ms;
+    }
+
+    /* Only zero-length entries: nothing to walk, hold the first one */
+    if (period_ms == 0) {
+        led_frame_fill(out->frame, frame->mask);
+        out->level = LED_LEVEL_FULL;
+        out->duration_ms = 1;
+        return 0;
+    }
+
+    /* Walk the table up to the entry that covers t_ms */
+    t_ms %= period_ms;
+    while (t_ms >= frame->duration_ms) {
+        t_ms -= frame->duration_ms;
+        frame++;
+    }
+
+    led_frame_fill(out->frame, frame->mask);
+    out->level = LED_LEVEL_FULL;
+    out->duration_ms = frame->duration_ms - t_ms;
+
+    return period_ms;
+}
+
+void led_pattern_random(struct led_frame *frame, uint32_t seed)
+{
+    /* Golden-ratio spread of the seed, never zero */
+    uint32_t x = seed * 0x9E3779B9U | 1U;
+    size_t words = led_frame_words();
+
+    for (size_t w = 0; w < words; w++) {
+        uint32_t empty;
+
+        /* xorshift32 (Marsaglia), taps 13/17/5 */
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+
+        /*
+         * Avoid all-off groups: every 4-LED group that came out dark
+         * shows [*-*-] instead. "empty" has bit 0 of each dark group set.
+         */
+        empty = ~(x | (x >> 1) | (x >> 2) | (x >> 3)) & 0x11111111U;
+        frame->words[w] = x | (empty * 0x5U);
+    }
+}
@@ -0,0 +1,123 @@
+/*
+ * LED Pattern Playback Engine
+ *
+ * Description: Plays fixed LED sequences stored as const frame tables.
+ *              Each table entry is a complete frame (LED bitmask) plus the
+ *              time it stays on, so an effect is data rather than code.
+ *
+ *              Entries describe a group of LED_PATTERN_GROUP LEDs; the
+ *              group is repeated along the whole LED set, so the same
+ *              table drives 4 LEDs or several hundred.
+ *
+ * License:     MIT
+ */
+
+#ifndef LED_PATTERN_H_
+#define LED_PATTERN_H_
+
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+
+#include "led_effect.h"
+#include "led_frame.h"
+
+/* ============================================================================
+ * PATTERN DEFINITIONS
+ * ============================================================================
+ */
+
+/** LEDs described by one pattern entry, repeated along the LED set */
+#define LED_PATTERN_GROUP 4
+
+/**
+ * @brief Repeat a LED_PATTERN_GROUP-bit mask over a whole frame word
+ */
+#define LED_PATTERN_TILE(_mask) \
+    ((led_mask_t)((_mask) & BIT_MASK(LED_PATTERN_GROUP)) * 0x11111111U)
+
+/**
+ * @brief One entry of a frame table
+ */
+struct led_pattern_frame {
+    led_mask_t mask;        /* Frame word, LEDs ON during this frame */
+    uint16_t duration_ms;   /* How long the frame is shown */
+};
+
+/**
+ * @brief A looping frame table
+ */
+struct led_pattern {
+    const struct led_pattern_frame *frames; /* Frame table (in flash) */
+    uint16_t num_frames;                    /* Frames in one cycle */
+};
+
+/**
+ * @brief Build a frame table entry
+ *
+ * @param _mask        LED bitmask of one group, bit N = LED N of the group
+ * @param _duration_ms Display time in milliseconds
+ */
+#define LED_PATTERN_FRAME(_mask, _duration_ms) \
+    { .mask = LED_PATTERN_TILE(_mask), .duration_ms = (_duration_ms) }
+
+/**
+ * @brief Define and register a table-driven effect as const (flash) data
+ *
+ * Creates the frame table, its struct led_pattern and a registered
+ * struct led_effect named @p _var that plays it with led_pattern_step()
+ * and led_pattern_eval() (see LED_EFFECT_DEFINE_EVAL()). The table is
+ * private to the file.
+ *
+ * @param _var    Variable name of the resulting struct led_effect
+ * @param _id     Registry id (enum led_effect_id)
+ * @param _name   Human readable name
+ * @param _cycles Default cycles per show entry
+ * @param ...     LED_PATTERN_FRAME() entries making up one cycle
+ */
+#define LED_PATTERN_DEFINE(_var, _id, _name, _cycles, ...)              \
+    static const struct led_pattern_frame _var##_frames[] = {           \
+        __VA_ARGS__                                                     \
+    };                                                                  \
+    static const struct led_pattern _var##_pattern = {                  \
+        .frames = _var##_frames,                                        \
+        .num_frames = ARRAY_SIZE(_var##_frames),                        \
+    };                                                                  \
+    LED_EFFECT_DEFINE_EVAL(_var, _id, _name, led_pattern_step,          \
+                           led_pattern_eval, &_var##_pattern, _cycles)
+
+/* ============================================================================
+ * API
+ * ============================================================================
+ */
+
+/**
+ * @brief Step function shared by all table-driven effects
+ *
+ * Emits the next table entry; a cycle ends with the last entry.
+ * See led_effect_step_t.
+ */
+bool led_pattern_step(const struct led_effect *effect,
+                      struct effect_state *state, struct led_step *out);
+
+/**
+ * @brief Time function shared by all table-driven effects
+ *
+ * Finds the table entry shown at @p t_ms. See led_effect_eval_t; a table
+ * of zero-length entries has no cycle length and returns 0, which
+ * led_playlist_validate() rejects.
+ */
+uint32_t led_pattern_eval(const struct led_effect *effect, uint32_t t_ms,
+                          struct led_step *out);
+
+/**
+ * @brief Fill a frame with a pseudo-random pattern
+ *
+ * One xorshift32 word (32 LEDs) per frame word; no 4-LED group is left
+ * all off. The same @p seed gives the same frame.
+ *
+ * @param frame Frame to fill
+ * @param seed  Pattern number, e.g. a step counter
+ */
+void led_pattern_random(struct led_frame *frame, uint32_t seed);
+
+#endif /* LED_PATTERN_H_ */
@@ -0,0 +1,154 @@
+/*
+ * PWM LED Brightness Backend
+ *
+ * Description: One pwm_dt_spec per child of the pwm-leds node. The carrier
+ *              period comes from CONFIG_LED_SHOW_PWM_PERIOD_US rather than
+ *              the devicetree, whose default is often a flickery 50 Hz.
+ *
+ * License:     MIT
+ */
+
+#include <errno.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/pwm.h>
+
+#include "led_pwm.h"
+
+#if defined(CONFIG_LED_SHOW_PWM)
+
+#define PWM_LEDS_NODE   DT_COMPAT_GET_ANY_STATUS_OKAY(pwm_leds)
+#define PWM_PERIOD_NS   PWM_USEC(CONFIG_LED_SHOW_PWM_PERIOD_US)
+
+#define PWM_LED_SPEC(node_id) PWM_DT_SPEC_GET(node_id),
+
+static const struct pwm_dt_spec pwm_leds[] = {
+    DT_FOREACH_CHILD(PWM_LEDS_NODE, PWM_LED_SPEC)
+};
+
+static bool ready;
+
+int led_pwm_init(void)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(pwm_leds); i++) {
+        if (!pwm_is_ready_dt(&pwm_leds[i])) {
+            return -ENODEV;
+        }
+    }
+
+    ready = ARRAY_SIZE(pwm_leds) > 0;
+    if (!ready) {
+        return -ENODEV;
+    }
+
+    return led_pwm_set(NULL, 0);
+}
+
+bool led_pwm_available(void)
+{
+    return ready;
+}
+
+/**
+ * @brief Pulse width of a level, on a quadratic curve
+ */
+static uint32_t pwm_pulse(uint8_t level)
+{
+    /* pulse = period * (level / 255)^2 */
+    return (uint32_t)(((uint64_t)PWM_PERIOD_NS * level * level) /
+                      (LED_PWM_LEVEL_MAX * LED_PWM_LEVEL_MAX));
+}
+
+int led_pwm_set(const struct led_frame *frame, uint8_t level)
+{
+    uint32_t pulse = pwm_pulse(level);
+    int ret;
+
+    for (size_t i = 0; i < ARRAY_SIZE(pwm_leds); i++) {
+        ret = pwm_set_dt(&pwm_leds[i], PWM_PERIOD_NS,
+                         (frame != NULL && led_frame_test(frame, i)) ?
+                         pulse : 0);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+int led_pwm_set_blend(const struct led_frame *a, uint8_t level_a,
+                      const struct led_frame *b, uint8_t level_b)
+{
+    /* Pulse per LED class, indexed by (in b) << 1 | (in a) */
+    const uint32_t pulse[4] = {
+        0, pwm_pulse(level_a), pwm_pulse(level_b),
+        pwm_pulse(led_frame_blend_level(level_a, level_b)),
+    };
+    int ret;
+
+    for (size_t i = 0; i < ARRAY_SIZE(pwm_leds); i++) {
+        int cls = (led_frame_test(b, i) << 1) | led_frame_test(a, i);
+
+        ret = pwm_set_dt(&pwm_leds[i], PWM_PERIOD_NS, pulse[cls]);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+int led_pwm_set_levels(const uint8_t *levels, size_t count)
+{
+    int ret;
+
+    for (size_t i = 0; i < ARRAY_SIZE(pwm_leds); i++) {
+        ret = pwm_set_dt(&pwm_leds[i], PWM_PERIOD_NS,
+                         (i < count) ? pwm_pulse(levels[i]) : 0);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+#else /* !CONFIG_LED_SHOW_PWM */
+
+int led_pwm_init(void)
+{
+    return -ENODEV;
+}
+
+bool led_pwm_available(void)
+{
+    return false;
+}
+
+int led_pwm_set(const struct led_frame *frame, uint8_t level)
+{
+    ARG_UNUSED(frame);
+    ARG_UNUSED(level);
+
+    return -ENOTSUP;
+}
+
+int led_pwm_set_blend(const struct led_frame *a, uint8_t level_a,
+                      const struct led_frame *b, uint8_t level_b)
+{
+    ARG_UNUSED(a);
+    ARG_UNUSED(level_a);
+    ARG_UNUSED(b);
+    ARG_UNUSED(level_b);
+
+    return -ENOTSUP;
+}
+
+int led_pwm_set_levels(const uint8_t *levels, size_t count)
+{
+    ARG_UNUSED(levels);
+    ARG_UNUSED(count);
+
+    return -ENOTSUP;
+}
+
+#endif /* CONFIG_LED_SHOW_PWM */
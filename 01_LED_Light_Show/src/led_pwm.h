@@ -0,0 +1,71 @@
+/*
+ * PWM LED Brightness Backend
+ *
+ * Description: Hardware PWM brightness for the LEDs listed in the
+ *              devicetree pwm-leds node. Used by brightness effects when
+ *              available; callers fall back to GPIO otherwise.
+ *
+ * License:     MIT
+ */
+
+#ifndef LED_PWM_H_
+#define LED_PWM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "led_frame.h"
+
+/** Brightness level that means fully ON */
+#define LED_PWM_LEVEL_MAX  255
+
+/**
+ * @brief Check the PWM LEDs and turn them off
+ *
+ * @return 0 on success, -ENODEV if there are no usable PWM LEDs
+ */
+int led_pwm_init(void);
+
+/**
+ * @brief Whether brightness can be driven by hardware PWM
+ *
+ * @return true once led_pwm_init() succeeded
+ */
+bool led_pwm_available(void);
+
+/**
+ * @brief Set the PWM LEDs selected by a frame to one brightness
+ *
+ * PWM LED N (child N of the pwm-leds node) is treated as LED N. LEDs not
+ * in @p frame are turned off. The 8-bit level is mapped through a
+ * quadratic (gamma 2) curve so that equal level steps look like equal
+ * brightness steps.
+ *
+ * @param frame LEDs to light, bit N = PWM LED N; NULL turns all off
+ * @param level 0 (off) to LED_PWM_LEVEL_MAX (fully on)
+ *
+ * @return 0 on success, negative error code from the PWM driver
+ */
+int led_pwm_set(const struct led_frame *frame, uint8_t level);
+
+/**
+ * @brief Set the PWM LEDs from two frames, each at its own brightness
+ *
+ * LEDs lit in both frames get led_frame_blend_level(); see led_pwm_set().
+ *
+ * @return 0 on success, negative error code from the PWM driver
+ */
+int led_pwm_set_blend(const struct led_frame *a, uint8_t level_a,
+                      const struct led_frame *b, uint8_t level_b);
+
+/**
+ * @brief Set every PWM LED to its own brightness
+ *
+ * @param levels Brightness per LED, see led_pwm_set()
+ * @param count  Number of entries in @p levels (extra LEDs are turned off)
+ *
+ * @return 0 on success, negative error code from the PWM driver
+ */
+int led_pwm_set_levels(const uint8_t *levels, size_t count);
+
+#endif /* LED_PWM_H_ */
@@ -0,0 +1,1161 @@
+/*
+ * LED Show Runner
+ *
+ * Description: Effect sequencing as a small state machine on a work
+ *              queue. Runs on the system work queue, or on a dedicated
+ *              one with CONFIG_LED_SHOW_WORKQ. The work item is the
+ *              renderer: it fills the output queue ahead of time and the
+ *              output thread asks for more when it runs low
+ *              (frame_queue.c).
+ *              Control requests arrive on a k_event and run the renderer
+ *              with K_NO_WAIT; switches flush the queue so they never wait
+ *              for queued frames to drain.
+ *
+ *              The playlist is walked on the same absolute timeline as the
+ *              frames: the first frame of the next entry is rendered ahead
+ *              like any other, so every transition lands exactly on its
+ *              deadline. A new playlist is handed over through an atomic
+ *              pointer and taken by the renderer between two frames.
+ *
+ *              Effects with a time function are played from the effect
+ *              time instead of being stepped: a renderer that fell behind
+ *              skips the frames it missed, and a tempo change rewinds the
+ *              effect time to the frame on the LEDs before the frames
+ *              rendered ahead are dropped.
+ *
+ *              An entry with a fade time hands over to the next one by a
+ *              cross-fade: the outgoing effect keeps running as a second
+ *              layer while the incoming one starts, and both are queued
+ *              as blended frames at complementary Q15 levels.
+ *
+ *              The overlay layers of the playlist are composited over
+ *              every frame on a clock of their own that runs on across
+ *              entries. Frames of time-based effects are cut short when
+ *              an overlay changes; other frames hold the overlays.
+ *
+ *              All of the above runs per zone. A show with several zones
+ *              keeps them in a min-heap by deadline: the one work item
+ *              renders the zones that are due and queues one composited
+ *              frame, and the one output timer puts it on the LEDs.
+ *
+ * License:     MIT
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/logging/log.h>
+
+#include "effects.h"
+#include "frame_queue.h"
+#include "frame_stats.h"
+#include "led_output.h"
+#include "led_show.h"
+#include "led_strip_out.h"
+#include "led_tempo.h"
+
+LOG_MODULE_REGISTER(led_show, CONFIG_LED_SHOW_LOG_LEVEL);
+
+/**
+ * @brief What the next rendered frame is
+ */
+enum show_phase {
+    SHOW_PHASE_START,   /* Announce and reset the next effect */
+    SHOW_PHASE_RUN,     /* Render the next effect frame */
+    SHOW_PHASE_GAP,     /* All LEDs off for the entry's gap */
+    SHOW_PHASE_FADE,    /* Cross-fade into the next entry */
+};
+
+/* All request bits of the control channel */
+#define SHOW_CTL_ALL (LED_SHOW_CTL_NEXT | LED_SHOW_CTL_PREV |              \
+                      LED_SHOW_CTL_STOP | LED_SHOW_CTL_RESUME |            \
+                      LED_SHOW_CTL_PARAMS | LED_SHOW_CTL_PLAYLIST)
+
+/* Longest frame of a time-based effect, 0 = until its output changes */
+#if defined(CONFIG_LED_SHOW_EVAL)
+#define SHOW_EVAL_FRAME_MS CONFIG_LED_SHOW_EVAL_FRAME_MS
+#else
+#define SHOW_EVAL_FRAME_MS 0
+#endif
+
+/* Cross-fade levels: Q15 share of the incoming effect */
+#define SHOW_FADE_SHIFT 15
+#define SHOW_FADE_ONE   BIT(SHOW_FADE_SHIFT)
+
+#if defined(CONFIG_LED_SHOW_LEVELS) && defined(CONFIG_LED_SHOW_FADE)
+/* Levels of the incoming layer of a cross-fade, while compositing */
+static struct led_levels show_fade_levels;
+#endif
+
+/* ============================================================================
+ * WORK QUEUE
+ * ============================================================================
+ */
+
+#if defined(CONFIG_LED_SHOW_WORKQ)
+K_THREAD_STACK_DEFINE(show_workq_stack, CONFIG_LED_SHOW_WORKQ_STACK_SIZE);
+static struct k_work_q show_workq;
+#endif
+
+/**
+ * @brief Work queue all shows run on
+ */
+static struct k_work_q *show_queue(void)
+{
+#if defined(CONFIG_LED_SHOW_WORKQ)
+    static bool started;
+
+    if (!started) {
+        const struct k_work_queue_config cfg = { .name = "led_show" };
+
+        k_work_queue_init(&show_workq);
+        k_work_queue_start(&show_workq, show_workq_stack,
+                           K_THREAD_STACK_SIZEOF(show_workq_stack),
+                           CONFIG_LED_SHOW_WORKQ_PRIORITY, &cfg);
+        started = true;
+    }
+
+    return &show_workq;
+#else
+    return &k_sys_work_q;
+#endif
+}
+
+/* ============================================================================
+ * STATE MACHINE
+ * ============================================================================
+ * Runs per zone: every zone walks its playlist on its own timeline.
+ */
+
+/**
+ * @brief Print the timing figures at the end of every sequence loop
+ */
+static void show_report_loop(const struct led_show *show)
+{
+    struct frame_queue_stats stats;
+    struct led_frame_stats gpio;
+
+    frame_queue_get_stats(&stats);
+    led_frame_get_stats(&gpio);
+    LOG_INF("[LOOP] Restarting sequence... "
+            "(drift %d us, lateness %d us, worst %u us, underruns %u, "
+            "max depth %u, last switch %u us)",
+            stats.drift_us, stats.late_us, stats.max_late_us,
+            stats.underruns, stats.max_depth, stats.switch_last_us);
+    LOG_INF("[LOOP] GPIO: %u frames, %u unchanged, %u port writes, "
+            "%u skipped",
+            gpio.commits, gpio.frames_skipped, gpio.port_writes,
+            gpio.port_writes_skipped);
+    LOG_INF("[LOOP] Effect announce: last %u us, max %u us",
+            show->announce_us, show->announce_max_us);
+
+    if (led_strip_out_available()) {
+        struct led_strip_out_stats strip;
+
+        led_strip_out_get_stats(&strip);
+        LOG_INF("[LOOP] Strip: %u transfers, %u coalesced, %u errors, "
+                "last transfer %u us",
+                strip.transfers, strip.coalesced, strip.errors,
+                strip.last_xfer_us);
+    }
+}
+
+/**
+ * @brief Take the pending requests off the control channel
+ *
+ * @return LED_SHOW_CTL_* bits that were pending
+ */
+static uint32_t show_take_requests(struct led_show *show)
+{
+    uint32_t req = k_event_test(&show->ctl, SHOW_CTL_ALL);
+
+    k_event_clear(&show->ctl, req);
+
+    return req;
+}
+
+/**
+ * @brief Update the status events seen by led_show_wait()
+ */
+static void show_set_status(struct led_show *show, uint32_t status)
+{
+    k_event_clear(&show->ctl, LED_SHOW_EVT_RUNNING | LED_SHOW_EVT_STOPPED);
+    k_event_post(&show->ctl, status);
+}
+
+/**
+ * @brief Apply control requests to every zone
+ *
+ * @return true if new effects must start now (switch or resume)
+ */
+static bool show_apply_requests(struct led_show *show, uint32_t req)
+{
+    if (!(req & (LED_SHOW_CTL_NEXT | LED_SHOW_CTL_PREV |
+                 LED_SHOW_CTL_RESUME))) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < show->num_zones; i++) {
+        struct led_zone *zone = &show->zones[i];
+        uint16_t num = zone->playlist->num_entries;
+
+        if (req & LED_SHOW_CTL_NEXT) {
+            zone->item = (zone->item + 1) % num;
+        } else if (req & LED_SHOW_CTL_PREV) {
+            zone->item = (zone->item + num - 1) % num;
+        }
+    }
+
+    if (show->stopped && !(req & LED_SHOW_CTL_RESUME)) {
+        /* Selection changed while stopped: takes effect on resume */
+        return false;
+    }
+
+    show->stopped = false;
+    show->off_pending = false;
+    for (uint8_t i = 0; i < show->num_zones; i++) {
+        show->zones[i].phase = SHOW_PHASE_START;
+    }
+    show_set_status(show, LED_SHOW_EVT_RUNNING);
+
+    return true;
+}
+
+/**
+ * @brief Log an effect starting and time how long that holds the renderer
+ *
+ * With deferred logging this only packages the message; formatting and
+ * the UART run later in the log thread.
+ */
+static void show_announce(struct led_show *show, const struct led_zone *zone,
+                          const char *name)
+{
+    uint32_t start = k_cycle_get_32();
+
+    if (zone == &show->zones[0]) {
+        LOG_INF("[Effect] %s", name);
+    } else {
+        LOG_INF("[Zone %u] %s", (unsigned int)(zone - show->zones), name);
+    }
+
+    show->announce_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+    show->announce_max_us = MAX(show->announce_max_us, show->announce_us);
+}
+
+/**
+ * @brief Ticks per effect ms for a tempo, 32.32 fixed point
+ *
+ * Combines the show tempo (led_tempo.h), the entry tempo, the show speed
+ * and the zone speed; 200 % speed halves every duration.
+ */
+static uint64_t show_rate(const struct led_show *show,
+                          const struct led_zone *zone, uint32_t tempo_pct)
+{
+    uint64_t rate = led_tempo_ticks_per_ms() * LED_SHOW_SPEED_NOMINAL /
+                    tempo_pct * LED_SHOW_SPEED_NOMINAL /
+                    (uint32_t)atomic_get(&show->speed_pct);
+
+#if defined(CONFIG_LED_SHOW_ZONES)
+    rate = rate * LED_SHOW_SPEED_NOMINAL / zone->speed_pct;
+#else
+    ARG_UNUSED(zone);
+#endif
+
+    return rate;
+}
+
+/**
+ * @brief Effect ms in @p ticks of zone time at the last frame's rate
+ */
+static uint32_t zone_ticks_to_effect_ms(const struct led_zone *zone,
+                                        k_ticks_t ticks)
+{
+    return (uint32_t)(((uint64_t)ticks << 32) / zone->rate);
+}
+
+/**
+ * @brief Skip the frames of a time-based effect whose deadline passed
+ *
+ * Moves the timeline and the effect time to "now" together, so a late
+ * renderer drops frames instead of stretching the effect.
+ */
+static void zone_catch_up(struct led_zone *zone)
+{
+    k_ticks_t behind = k_uptime_ticks() - zone->sched.deadline;
+    uint32_t ms = (behind > 0) ? zone_ticks_to_effect_ms(zone, behind) : 0;
+
+    if (ms == 0) {
+        return;
+    }
+
+    frame_sched_advance(&zone->sched, ms, zone->rate);
+    zone->t_ms += ms;
+#if defined(CONFIG_LED_SHOW_LAYERS)
+    zone->layer_ms += ms;
+#endif
+}
+
+/**
+ * @brief Render the frame of a time-based effect at the effect time
+ *
+ * @return Effect time until the next frame
+ */
+static uint32_t zone_eval(struct led_zone *zone,
+                          const struct led_playlist_entry *entry,
+                          struct led_step *step)
+{
+    const struct led_effect *effect = zone->effect;
+    uint32_t delay_ms;
+
+    zone->end_ms = effect->eval(effect, zone->t_ms, step) * entry->cycles;
+    if (zone->end_ms == 0) {
+        /* No cycle length (see led_playlist_validate()): nothing to play */
+        zone->phase = SHOW_PHASE_GAP;
+        return MAX(step->duration_ms, 1U);
+    }
+    if (zone->t_ms >= zone->end_ms) {
+        /* Skipped past the end: show the last frame */
+        zone->t_ms = zone->end_ms - 1;
+        effect->eval(effect, zone->t_ms, step);
+    }
+
+    delay_ms = MIN(step->duration_ms, zone->end_ms - zone->t_ms);
+#if SHOW_EVAL_FRAME_MS > 0
+    delay_ms = MIN(delay_ms, SHOW_EVAL_FRAME_MS);
+#endif
+
+    zone->t_ms += delay_ms;
+    if (zone->t_ms >= zone->end_ms) {
+        zone->phase = SHOW_PHASE_GAP;
+    }
+
+    return delay_ms;
+}
+
+/**
+ * @brief Take the effect and overlay times back to the frame on the LEDs
+ *
+ * Called before the frames rendered ahead are flushed, with the timeline
+ * still at the deadline of the next frame to render.
+ */
+static void zone_rewind(struct led_zone *zone)
+{
+    k_ticks_t ahead = zone->sched.deadline - k_uptime_ticks();
+    uint32_t ms;
+
+    if (zone->phase == SHOW_PHASE_START || ahead <= 0) {
+        return;
+    }
+
+    ms = zone_ticks_to_effect_ms(zone, ahead);
+#if defined(CONFIG_LED_SHOW_LAYERS)
+    zone->layer_ms -= MIN(zone->layer_ms, ms);
+#endif
+    if (!zone->timed || zone->phase == SHOW_PHASE_FADE) {
+        return;
+    }
+
+    zone->t_ms -= MIN(zone->t_ms, ms);
+    if (zone->t_ms < zone->end_ms) {
+        zone->phase = SHOW_PHASE_RUN;
+    }
+}
+
+/**
+ * @brief Start the effect of the current entry
+ */
+static void zone_start(struct led_show *show, struct led_zone *zone,
+                       const struct led_playlist_entry *entry)
+{
+    zone->effect = led_effect_get(entry->effect);
+    show_announce(show, zone, zone->effect->name);
+    zone->state = (struct effect_state){ 0 };
+    zone->cycle = 0;
+    zone->timed = IS_ENABLED(CONFIG_LED_SHOW_EVAL) &&
+                  zone->effect->eval != NULL;
+    zone->t_ms = 0;
+    zone->phase = SHOW_PHASE_RUN;
+}
+
+/**
+ * @brief Move on to the next playlist entry
+ *
+ * The timing figures are reported when zone 0 loops.
+ *
+ * @return true if the playlist wrapped around
+ */
+static bool zone_next_item(struct led_show *show, struct led_zone *zone)
+{
+    if (++zone->item < zone->playlist->num_entries) {
+        return false;
+    }
+
+    zone->item = 0;
+    if (zone == &show->zones[0]) {
+        show_report_loop(show);
+    }
+
+    return true;
+}
+
+#if defined(CONFIG_LED_SHOW_FADE)
+/**
+ * @brief Bring a cross-fade layer to a new frame once its frame is over
+ *
+ * @return true if a step effect completed a cycle
+ */
+static bool show_layer_next(struct led_show_layer *layer)
+{
+    struct led_step step = { .frame = &layer->frame };
+    bool cycle_end = false;
+
+    if (layer->left_ms > 0) {
+        return false;
+    }
+
+    if (layer->timed) {
+        layer->effect->eval(layer->effect, layer->t_ms, &step);
+    } else {
+        cycle_end = layer->effect->step(layer->effect, &layer->state, &step);
+    }
+    layer->level = step.level;
+    layer->left_ms = step.duration_ms;
+
+    return cycle_end;
+}
+
+/**
+ * @brief Advance a cross-fade layer by @p ms of effect time
+ */
+static void show_layer_advance(struct led_show_layer *layer, uint32_t ms)
+{
+    layer->left_ms -= ms;
+    layer->t_ms += ms;
+}
+
+/**
+ * @brief Turn the running effect into the outgoing layer of a cross-fade
+ *        and start the current entry as the incoming one
+ */
+static void zone_fade_begin(struct led_show *show, struct led_zone *zone,
+                            uint16_t fade_ms)
+{
+    struct led_show_layer *from = &zone->fade_out;
+    struct led_show_layer *to = &zone->fade_in;
+
+    /* Its last frame was shown in full: continue with the next one */
+    from->effect = zone->effect;
+    from->state = zone->state;
+    from->t_ms = zone->t_ms;
+    from->timed = zone->timed;
+    from->left_ms = 0;
+
+    zone_start(show, zone, &zone->playlist->entries[zone->item]);
+    to->effect = zone->effect;
+    to->state = zone->state;
+    to->t_ms = 0;
+    to->timed = zone->timed;
+    to->left_ms = 0;
+
+    zone->fade_ms = fade_ms;
+    zone->fade_elapsed_ms = 0;
+    zone->phase = SHOW_PHASE_FADE;
+}
+
+/**
+ * @brief Render one blended frame of a cross-fade
+ *
+ * A frame lasts until either layer changes frame or the levels are due
+ * for an update. Once the fade is over the incoming layer finishes the
+ * frame it is on, then the zone carries on with its state.
+ *
+ * @return Effect time until the next frame
+ */
+static uint32_t zone_fade(struct led_zone *zone, struct led_qframe *out)
+{
+    struct led_show_layer *from = &zone->fade_out;
+    struct led_show_layer *to = &zone->fade_in;
+    uint32_t fade_left = zone->fade_ms - MIN(zone->fade_elapsed_ms,
+                                             zone->fade_ms);
+    uint32_t alpha;
+    uint32_t delay_ms;
+
+    if (show_layer_next(to)) {
+        zone->cycle++;
+    }
+    delay_ms = to->left_ms;
+
+    if (fade_left > 0) {
+        show_layer_next(from);
+        delay_ms = MIN(delay_ms, from->left_ms);
+        delay_ms = MIN(delay_ms, MIN(fade_left, CONFIG_LED_SHOW_FADE_STEP_MS));
+        alpha = zone->fade_elapsed_ms * SHOW_FADE_ONE / zone->fade_ms;
+    } else {
+        alpha = SHOW_FADE_ONE;
+    }
+
+    led_frame_copy(&out->frame, &from->frame);
+    out->level = (uint8_t)((from->level * (SHOW_FADE_ONE - alpha)) >>
+                           SHOW_FADE_SHIFT);
+    led_frame_copy(&out->frame2, &to->frame);
+    out->level2 = (uint8_t)((to->level * alpha) >> SHOW_FADE_SHIFT);
+    out->flags |= FRAME_FLAG_BLEND;
+    if (alpha >= SHOW_FADE_ONE / 2) {
+        out->flags |= FRAME_FLAG_CUT;
+    }
+
+    if (fade_left > 0) {
+        show_layer_advance(from, delay_ms);
+    }
+    show_layer_advance(to, delay_ms);
+    zone->fade_elapsed_ms += (uint16_t)MIN(delay_ms, fade_left);
+
+    if (zone->fade_elapsed_ms >= zone->fade_ms && to->left_ms == 0) {
+        /* Incoming effect on a frame boundary: play it on its own */
+        zone->state = to->state;
+        zone->t_ms = to->t_ms;
+        zone->phase = SHOW_PHASE_RUN;
+    }
+
+    return delay_ms;
+}
+#endif /* CONFIG_LED_SHOW_FADE */
+
+#if defined(CONFIG_LED_SHOW_LEVELS)
+/**
+ * @brief Turn a rendered frame into one shown from its levels
+ */
+static void show_to_levels(struct led_qframe *frame)
+{
+    if (frame->flags & FRAME_FLAG_LEVELS) {
+        return;
+    }
+
+    led_levels_from_frame(&frame->levels, &frame->frame, frame->level);
+#if defined(CONFIG_LED_SHOW_FADE)
+    if (frame->flags & FRAME_FLAG_BLEND) {
+        led_levels_from_frame(&show_fade_levels, &frame->frame2,
+                              frame->level2);
+        led_blend(LED_BLEND_ADD, frame->levels.words, show_fade_levels.words,
+                  led_levels_words(), LED_BLEND_OPAQUE);
+        frame->flags &= ~(FRAME_FLAG_BLEND | FRAME_FLAG_CUT);
+    }
+#endif
+    frame->flags |= FRAME_FLAG_LEVELS;
+}
+#endif /* CONFIG_LED_SHOW_LEVELS */
+
+#if defined(CONFIG_LED_SHOW_LAYERS)
+/**
+ * @brief Composite the overlay layers over a rendered frame
+ *
+ * @return Time until an overlay changes
+ */
+static uint32_t zone_composite(struct led_zone *zone, struct led_qframe *out)
+{
+    const struct led_playlist *playlist = zone->playlist;
+
+    show_to_levels(out);
+
+    return led_layers_render(playlist->layers, playlist->num_layers,
+                             zone->layer_ms, &out->levels);
+}
+#endif /* CONFIG_LED_SHOW_LAYERS */
+
+/**
+ * @brief Render the frame of a zone at its current deadline
+ *
+ * Advances the effect and the timeline of the zone by one frame.
+ */
+static void zone_render(struct led_show *show, struct led_zone *zone,
+                        struct led_qframe *out)
+{
+    const struct led_playlist_entry *entry =
+        &zone->playlist->entries[zone->item];
+    struct led_step step = { .frame = &out->frame };
+    uint32_t tempo_pct = LED_SHOW_SPEED_NOMINAL;
+    bool evaluated = false;
+    uint32_t delay_ms;
+
+    if (zone->timed && zone->phase == SHOW_PHASE_RUN) {
+        zone_catch_up(zone);
+    }
+
+    out->deadline = zone->sched.deadline;
+    out->flags = 0;
+    out->source = (uint8_t)zone->item;
+
+    switch (zone->phase) {
+    case SHOW_PHASE_START:
+        zone_start(show, zone, entry);
+        __fallthrough;
+
+    case SHOW_PHASE_RUN:
+        if (zone->timed) {
+            delay_ms = zone_eval(zone, entry, &step);
+            evaluated = true;
+        } else {
+            if (zone->effect->step(zone->effect, &zone->state, &step) &&
+                ++zone->cycle >= entry->cycles) {
+                zone->phase = SHOW_PHASE_GAP;
+            }
+            delay_ms = step.duration_ms;
+        }
+        out->level = step.level;
+        tempo_pct = entry->tempo_pct;
+        break;
+
+#if defined(CONFIG_LED_SHOW_FADE)
+    case SHOW_PHASE_FADE:
+        delay_ms = zone_fade(zone, out);
+        tempo_pct = entry->tempo_pct;
+        break;
+#endif
+
+    case SHOW_PHASE_GAP:
+    default:
+        if (zone_next_item(show, zone)) {
+            out->flags |= FRAME_FLAG_LOOP;
+        }
+#if defined(CONFIG_LED_SHOW_FADE)
+        if (entry->fade_ms > 0) {
+            /* Both effects run at the tempo of the incoming entry */
+            zone_fade_begin(show, zone, entry->fade_ms);
+            entry = &zone->playlist->entries[zone->item];
+            out->source = (uint8_t)zone->item;
+            delay_ms = zone_fade(zone, out);
+            tempo_pct = entry->tempo_pct;
+            break;
+        }
+#endif
+        led_frame_clear(&out->frame);
+        out->level = LED_LEVEL_FULL;
+        delay_ms = entry->gap_ms;
+        zone->phase = SHOW_PHASE_START;
+        break;
+    }
+
+#if defined(CONFIG_LED_SHOW_LAYERS)
+    if (zone->playlist->num_layers > 0) {
+        uint32_t layer_next_ms = zone_composite(zone, out);
+
+        if (evaluated && delay_ms > layer_next_ms) {
+            /* Effect time is a free variable: end the frame early */
+            zone->t_ms -= delay_ms - layer_next_ms;
+            zone->phase = SHOW_PHASE_RUN;
+            delay_ms = layer_next_ms;
+        }
+    }
+    zone->layer_ms += delay_ms;
+#else
+    ARG_UNUSED(evaluated);
+#endif
+
+    /* Tempo scaling in fixed point, sub-tick remainders carried */
+    zone->rate = show_rate(show, zone, tempo_pct);
+    frame_sched_advance(&zone->sched, delay_ms, zone->rate);
+}
+
+#if defined(CONFIG_LED_SHOW_ZONES)
+/* ============================================================================
+ * ZONES
+ * ============================================================================
+ * The zones wait in a binary min-heap keyed by the deadline of their next
+ * frame. Each output frame renders the zones due at the earliest deadline
+ * and composites the current frames of all zones, so the output timer
+ * fires once per change of any zone and never in between.
+ */
+
+/**
+ * @brief Whether zone @p a is due before zone @p b
+ */
+static bool zone_before(const struct led_show *show, uint8_t a, uint8_t b)
+{
+    return show->zones[a].sched.deadline < show->zones[b].sched.deadline;
+}
+
+/**
+ * @brief Move the zone at heap position @p pos down to its place
+ *
+ * On a tie the zone goes below the other one, so a zone that was just
+ * rendered lets the zones due at the same deadline up.
+ */
+static void zone_heap_down(struct led_show *show, uint8_t pos)
+{
+    uint8_t *heap = show->heap;
+
+    for (;;) {
+        uint8_t min = pos;
+        uint8_t left = 2 * pos + 1;
+        uint8_t right = left + 1;
+        uint8_t tmp;
+
+        if (left < show->num_zones &&
+            !zone_before(show, heap[min], heap[left])) {
+            min = left;
+        }
+        if (right < show->num_zones &&
+            !zone_before(show, heap[min], heap[right])) {
+            min = right;
+        }
+        if (min == pos) {
+            return;
+        }
+
+        tmp = heap[pos];
+        heap[pos] = heap[min];
+        heap[min] = tmp;
+        pos = min;
+    }
+}
+
+/**
+ * @brief Order all zones by deadline
+ */
+static void zone_heap_build(struct led_show *show)
+{
+    for (uint8_t i = 0; i < show->num_zones; i++) {
+        show->heap[i] = i;
+    }
+    for (int i = show->num_zones / 2 - 1; i >= 0; i--) {
+        zone_heap_down(show, (uint8_t)i);
+    }
+}
+
+/**
+ * @brief Render the zones due at the earliest deadline, then composite
+ *        the frames of all zones into a queue slot
+ *
+ * A zone with frames of no length stays due at the same deadline. It is
+ * not rendered again into the same slot: the slot is closed once a zone
+ * already rendered comes back to the top, and any zone still due at that
+ * deadline goes into the next slot.
+ */
+static void show_render_zones(struct led_show *show, struct led_qframe *out)
+{
+    struct led_zone *zone = &show->zones[show->heap[0]];
+    k_ticks_t deadline = zone->sched.deadline;
+    size_t words = led_levels_words();
+    uint16_t rendered = 0;
+    uint8_t flags = 0;
+
+    BUILD_ASSERT(LED_SHOW_MAX_ZONES <= 16, "rendered has 16 bits");
+
+    while (zone->sched.deadline == deadline &&
+           !(rendered & BIT(show->heap[0]))) {
+        rendered |= BIT(show->heap[0]);
+        zone_render(show, zone, &zone->frame);
+        show_to_levels(&zone->frame);
+        led_levels_mask(&zone->frame.levels, &zone->leds);
+        if (zone == &show->zones[0]) {
+            flags = zone->frame.flags & FRAME_FLAG_LOOP;
+        }
+
+        zone_heap_down(show, 0);
+        zone = &show->zones[show->heap[0]];
+    }
+
+    out->deadline = deadline;
+    out->flags = flags | FRAME_FLAG_LEVELS;
+    out->source = show->zones[0].frame.source;
+    out->level = LED_LEVEL_FULL;
+    led_frame_clear(&out->frame);
+    memset(out->levels.words, 0, words * sizeof(out->levels.words[0]));
+
+    for (uint8_t i = 0; i < show->num_zones; i++) {
+        zone = &show->zones[i];
+
+        /* Zones do not overlap: adding them up puts them side by side */
+        led_blend(LED_BLEND_ADD, out->levels.words, zone->frame.levels.words,
+                  words, LED_BLEND_OPAQUE);
+        for (size_t w = 0; w < led_frame_words(); w++) {
+            out->frame.words[w] |= zone->frame.frame.words[w] &
+                                   zone->leds.words[w];
+        }
+    }
+}
+#endif /* CONFIG_LED_SHOW_ZONES */
+
+/**
+ * @brief Render the next frame of the show into a queue slot
+ */
+static void show_render(struct led_show *show, struct led_qframe *out)
+{
+#if defined(CONFIG_LED_SHOW_ZONES)
+    if (show->num_zones > 1) {
+        show_render_zones(show, out);
+        return;
+    }
+#endif
+
+    zone_render(show, &show->zones[0], out);
+}
+
+/**
+ * @brief Start every zone's timeline at the current tick
+ *
+ * All zones share one origin, so zones with frames of equal length stay
+ * on the same deadlines and are composited into the same output frames.
+ *
+ * @param resync Re-anchor the timelines instead of starting them
+ */
+static void show_sched_start(struct led_show *show, bool resync)
+{
+    if (resync) {
+        frame_sched_resync(&show->zones[0].sched);
+    } else {
+        frame_sched_start(&show->zones[0].sched);
+    }
+
+    for (uint8_t i = 1; i < show->num_zones; i++) {
+        show->zones[i].sched = show->zones[0].sched;
+    }
+
+#if defined(CONFIG_LED_SHOW_ZONES)
+    zone_heap_build(show);
+#endif
+}
+
+/**
+ * @brief Name the timing statistics sources after the playlist entries
+ *
+ * Sources past the end of the playlist are left without a name, so none
+ * keeps the name of an entry of a previous, longer playlist.
+ */
+static void show_name_sources(const struct led_playlist *playlist)
+{
+    for (int i = 0; i < frame_stats_num_sources(); i++) {
+        const struct led_effect *effect = (i < playlist->num_entries) ?
+            led_effect_get(playlist->entries[i].effect) : NULL;
+
+        frame_stats_set_name(i, (effect != NULL) ? effect->name : NULL);
+    }
+}
+
+/**
+ * @brief Switch zone 0 to the playlist posted by led_show_set_playlist()
+ *
+ * The new playlist starts from its first entry; frames rendered ahead
+ * from the old one are flushed by the caller.
+ */
+static void show_take_playlist(struct led_show *show)
+{
+    const struct led_playlist *playlist = atomic_ptr_clear(&show->pending);
+    struct led_zone *zone = &show->zones[0];
+
+    if (playlist == NULL) {
+        return;
+    }
+
+    zone->playlist = playlist;
+    zone->item = 0;
+    zone->phase = SHOW_PHASE_START;
+
+    /* Figures per source belong to the entries of the old playlist */
+    frame_stats_reset();
+    show_name_sources(playlist);
+    k_event_post(&show->ctl, LED_SHOW_EVT_PLAYLIST);
+}
+
+/**
+ * @brief Queue an all-off frame that ends the output stream
+ *
+ * @return false if the queue is still full of flushed frames
+ */
+static bool show_queue_off(void)
+{
+    struct led_qframe *frame = frame_queue_acquire();
+
+    if (frame == NULL) {
+        return false;
+    }
+
+    frame->deadline = k_uptime_ticks();
+    frame->source = UINT8_MAX;
+    led_frame_clear(&frame->frame);
+    frame->level = LED_LEVEL_FULL;
+    frame->flags = FRAME_FLAG_END;
+    frame_queue_produce();
+
+    return true;
+}
+
+/**
+ * @brief Renderer: apply requests, then fill the output queue
+ *
+ * A flush only frees the ring once the output thread has dropped the stale
+ * frames; until then acquire fails and the work left (the all-off frame
+ * of a stop, the latency mark of a switch) stays pending for the refill
+ * the output thread triggers right after.
+ */
+static void show_work_handler(struct k_work *work)
+{
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct led_show *show = CONTAINER_OF(dwork, struct led_show, work);
+    uint32_t req = show_take_requests(show);
+    struct led_qframe *frame;
+
+    if (req & LED_SHOW_CTL_STOP) {
+        show->stopped = true;
+        show->off_pending = true;
+        frame_queue_flush();
+    }
+
+    if (req & LED_SHOW_CTL_PLAYLIST) {
+        show_take_playlist(show);
+        if (!show->stopped) {
+            req |= LED_SHOW_CTL_PARAMS;
+        }
+    }
+
+    if (show_apply_requests(show, req)) {
+        show->mark_pending =
+            (req & (LED_SHOW_CTL_NEXT | LED_SHOW_CTL_PREV)) != 0;
+        req |= LED_SHOW_CTL_PARAMS;
+    }
+
+    if (show->stopped) {
+        if (show->off_pending && show_queue_off()) {
+            show->off_pending = false;
+            show_set_status(show, LED_SHOW_EVT_STOPPED);
+        }
+        return;
+    }
+
+    if (req & LED_SHOW_CTL_PARAMS) {
+        /* Frames rendered ahead are obsolete: drop them, restart "now" */
+        for (uint8_t i = 0; i < show->num_zones; i++) {
+            zone_rewind(&show->zones[i]);
+        }
+        frame_queue_flush();
+        show_sched_start(show, true);
+    }
+
+    while ((frame = frame_queue_acquire()) != NULL) {
+        show_render(show, frame);
+        if (show->mark_pending) {
+            frame->flags |= FRAME_FLAG_MARK;
+            frame->stamp = show->req_cycles;
+            show->mark_pending = false;
+        }
+        frame_queue_produce();
+    }
+}
+
+/**
+ * @brief Output queue refill callback (output thread)
+ */
+static void show_refill(void *user_data)
+{
+    struct led_show *show = user_data;
+
+    k_work_reschedule_for_queue(show_queue(), &show->work, K_NO_WAIT);
+}
+
+/* ============================================================================
+ * API
+ * ============================================================================
+ */
+
+/**
+ * @brief Whether an effect played by time has a cycle length
+ *
+ * zone_eval() plays an effect for cycles times its eval() period, so a
+ * period of 0 ms (e.g. a table of zero-length frames) can't be played.
+ */
+static bool show_effect_has_period(const struct led_effect *effect)
+{
+    struct led_frame frame;
+    struct led_step step = { .frame = &frame };
+
+    return effect->eval == NULL || effect->eval(effect, 0, &step) > 0;
+}
+
+int led_playlist_validate(const struct led_playlist *playlist)
+{
+    if (playlist == NULL || playlist->num_entries == 0) {
+        return -EINVAL;
+    }
+
+    for (size_t i = 0; i < playlist->num_entries; i++) {
+        const struct led_playlist_entry *entry = &playlist->entries[i];
+        const struct led_effect *effect;
+
+        if (entry->cycles == 0 || entry->tempo_pct == 0) {
+            return -EINVAL;
+        }
+        effect = led_effect_get(entry->effect);
+        if (effect == NULL) {
+            return -ENOENT;
+        }
+        if (!show_effect_has_period(effect)) {
+            return -EINVAL;
+        }
+    }
+
+    return led_layers_validate(playlist->layers, playlist->num_layers);
+}
+
+void led_show_init(struct led_show *show, const struct led_playlist *playlist)
+{
+    struct led_zone *zone = &show->zones[0];
+
+    k_work_init_delayable(&show->work, show_work_handler);
+    k_event_init(&show->ctl);
+    zone->playlist = playlist;
+#if defined(CONFIG_LED_SHOW_ZONES)
+    memset(&zone->leds, 0xFF, sizeof(zone->leds));
+    zone->speed_pct = LED_SHOW_SPEED_NOMINAL;
+#endif
+    show->num_zones = 1;
+    atomic_ptr_clear(&show->pending);
+    show->stopped = true;
+    atomic_set(&show->speed_pct, LED_SHOW_SPEED_NOMINAL);
+    k_event_post(&show->ctl, LED_SHOW_EVT_STOPPED);
+
+    frame_queue_init(show_refill, show);
+
+    /* Timing figures are kept per playlist entry */
+    show_name_sources(playlist);
+}
+
+int led_show_add_zone(struct led_show *show, const struct led_frame *leds,
+                      const struct led_playlist *playlist, uint16_t speed_pct)
+{
+#if defined(CONFIG_LED_SHOW_ZONES)
+    struct led_zone *zone;
+    int ret = led_playlist_validate(playlist);
+
+    if (ret < 0) {
+        return ret;
+    }
+    if (speed_pct == 0) {
+        return -EINVAL;
+    }
+    if (show->num_zones >= LED_SHOW_MAX_ZONES) {
+        return -ENOSPC;
+    }
+
+    /* Zones do not overlap: the LEDs leave the zones they were in */
+    for (uint8_t i = 0; i < show->num_zones; i++) {
+        for (size_t w = 0; w < LED_FRAME_WORDS; w++) {
+            show->zones[i].leds.words[w] &= ~leds->words[w];
+        }
+    }
+
+    zone = &show->zones[show->num_zones];
+    memset(zone, 0, sizeof(*zone));
+    zone->playlist = playlist;
+    led_frame_copy(&zone->leds, leds);
+    zone->speed_pct = speed_pct;
+
+    return show->num_zones++;
+#else
+    ARG_UNUSED(show);
+    ARG_UNUSED(leds);
+    ARG_UNUSED(playlist);
+    ARG_UNUSED(speed_pct);
+
+    return -ENOTSUP;
+#endif
+}
+
+void led_show_start(struct led_show *show)
+{
+    show->stopped = false;
+    show->off_pending = false;
+    show->mark_pending = false;
+    for (uint8_t i = 0; i < show->num_zones; i++) {
+        show->zones[i].item = 0;
+        show->zones[i].phase = SHOW_PHASE_START;
+    }
+    show_sched_start(show, false);
+    show_set_status(show, LED_SHOW_EVT_RUNNING);
+
+    k_work_reschedule_for_queue(show_queue(), &show->work, K_NO_WAIT);
+}
+
+void led_show_control(struct led_show *show, uint32_t requests)
+{
+    if (requests & (LED_SHOW_CTL_NEXT | LED_SHOW_CTL_PREV)) {
+        show->req_cycles = k_cycle_get_32();
+    }
+    k_event_post(&show->ctl, requests & SHOW_CTL_ALL);
+
+    /* Run the renderer right away instead of at the next refill */
+    k_work_reschedule_for_queue(show_queue(), &show->work, K_NO_WAIT);
+}
+
+uint32_t led_show_wait(struct led_show *show, uint32_t events,
+                       k_timeout_t timeout)
+{
+    return k_event_wait(&show->ctl, events, false, timeout);
+}
+
+int led_show_stop(struct led_show *show, k_timeout_t timeout)
+{
+    led_show_control(show, LED_SHOW_CTL_STOP);
+
+    return led_show_wait(show, LED_SHOW_EVT_STOPPED, timeout) ? 0 : -EAGAIN;
+}
+
+void led_show_set_speed(struct led_show *show, uint32_t speed_pct)
+{
+    if (speed_pct == 0) {
+        return;
+    }
+    atomic_set(&show->speed_pct, (atomic_val_t)speed_pct);
+    led_show_control(show, LED_SHOW_CTL_PARAMS);
+}
+
+int led_show_set_bpm(struct led_show *show, uint32_t bpm)
+{
+    int ret = led_tempo_set_bpm(bpm);
+
+    if (ret == 0) {
+        led_show_control(show, LED_SHOW_CTL_PARAMS);
+    }
+
+    return ret;
+}
+
+int led_show_tap(struct led_show *show)
+{
+    int ret = led_tempo_tap();
+
+    if (ret > 0) {
+        led_show_control(show, LED_SHOW_CTL_PARAMS);
+    }
+
+    return ret;
+}
+
+int led_show_set_playlist(struct led_show *show,
+                          const struct led_playlist *playlist,
+                          k_timeout_t timeout)
+{
+    int ret = led_playlist_validate(playlist);
+
+    if (ret < 0) {
+        return ret;
+    }
+
+    k_event_clear(&show->ctl, LED_SHOW_EVT_PLAYLIST);
+    atomic_ptr_set(&show->pending, (atomic_ptr_val_t)playlist);
+    led_show_control(show, LED_SHOW_CTL_PLAYLIST);
+
+    if (led_show_wait(show, LED_SHOW_EVT_PLAYLIST, timeout)) {
+        return 0;
+    }
+
+    /* Withdraw it, unless the renderer took it over in the meantime */
+    if (atomic_ptr_cas(&show->pending, (atomic_ptr_val_t)playlist, NULL)) {
+        return -EAGAIN;
+    }
+
+    return 0;
+}
+
+const struct led_playlist *led_show_get_playlist(const struct led_show *show)
+{
+    return show->zones[0].playlist;
+}
@@ -0,0 +1,303 @@
+/*
+ * LED Show Runner
+ *
+ * Description: Drives a sequence of effects from a delayable work item.
+ *              The work handler renders frames ahead of time into the
+ *              output queue (frame_queue.h), stamped with absolute
+ *              deadlines, so no thread is ever parked inside an effect.
+ *              With CONFIG_LED_SHOW_ZONES the LEDs can be split into zones
+ *              that play playlists of their own on separate timelines,
+ *              all rendered by the same work item.
+ *
+ * License:     MIT
+ */
+
+#ifndef LED_SHOW_H_
+#define LED_SHOW_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+#include "frame_queue.h"
+#include "frame_sched.h"
+#include "led_effect.h"
+#include "led_layer.h"
+
+/** Nominal show speed, in percent */
+#define LED_SHOW_SPEED_NOMINAL 100
+
+/** Zones a show can have */
+#if defined(CONFIG_LED_SHOW_ZONES)
+#define LED_SHOW_MAX_ZONES CONFIG_LED_SHOW_MAX_ZONES
+#else
+#define LED_SHOW_MAX_ZONES 1
+#endif
+
+/* ============================================================================
+ * CONTROL CHANNEL
+ * ============================================================================
+ * Requests are posted to the show's k_event with led_show_control() and
+ * take effect at once: posting wakes the show work item immediately
+ * instead of waiting for the current frame to end. Status events can be
+ * waited for from threads with led_show_wait().
+ */
+
+/* Requests */
+#define LED_SHOW_CTL_NEXT       BIT(0)  /* Skip to the next effect */
+#define LED_SHOW_CTL_PREV       BIT(1)  /* Go back to the previous effect */
+#define LED_SHOW_CTL_STOP       BIT(2)  /* Stop, all LEDs off */
+#define LED_SHOW_CTL_RESUME     BIT(3)  /* Restart the current effect */
+#define LED_SHOW_CTL_PARAMS     BIT(4)  /* Parameters changed, apply now */
+#define LED_SHOW_CTL_PLAYLIST   BIT(5)  /* Take over the pending playlist */
+
+/* Status events */
+#define LED_SHOW_EVT_RUNNING    BIT(16) /* Show is producing frames */
+#define LED_SHOW_EVT_STOPPED    BIT(17) /* Show is stopped, LEDs off */
+#define LED_SHOW_EVT_PLAYLIST   BIT(18) /* Pending playlist taken over */
+
+/* ============================================================================
+ * PLAYLIST
+ * ============================================================================
+ * What the show plays, as data: effects by registry id (effects.h), each
+ * with its repeat count, tempo and the pause after it. Played in a loop,
+ * with optional overlay layers (led_layer.h) composited over every frame.
+ */
+
+/**
+ * @brief One entry of a playlist
+ */
+struct led_playlist_entry {
+    uint8_t effect;         /* Effect id, enum led_effect_id */
+    uint16_t cycles;        /* Number of effect cycles */
+    uint16_t tempo_pct;     /* Effect tempo, LED_SHOW_SPEED_NOMINAL = 1x */
+    uint16_t gap_ms;        /* All-off pause after the effect */
+    uint16_t fade_ms;       /* Cross-fade into the next entry, 0 = none */
+};
+
+/**
+ * @brief A playlist
+ */
+struct led_playlist {
+    const struct led_playlist_entry *entries;
+    uint16_t num_entries;
+    const struct led_layer *layers;     /* Overlays, CONFIG_LED_SHOW_LAYERS */
+    uint16_t num_layers;
+};
+
+/**
+ * @brief One effect of a cross-fade, with the frame it is showing
+ */
+struct led_show_layer {
+    const struct led_effect *effect;    /* Effect of the layer */
+    struct effect_state state;          /* Its progress (step effects) */
+    uint32_t t_ms;                      /* Its time (time-based effects) */
+    bool timed;                         /* Played by its time function */
+    uint8_t level;                      /* Level of @p frame */
+    uint32_t left_ms;                   /* Effect time @p frame has left */
+    struct led_frame frame;             /* Frame being shown */
+};
+
+/**
+ * @brief One timeline of a show: a set of LEDs and the playlist they play
+ *
+ * Zone 0 has the LEDs of no other zone and plays the show's playlist.
+ */
+struct led_zone {
+    const struct led_playlist *playlist; /* Played in a loop */
+    const struct led_effect *effect;    /* Effect of the current entry */
+    uint16_t item;                      /* Current playlist entry */
+    uint16_t cycle;                     /* Completed cycles of the entry */
+    uint8_t phase;                      /* Start / run / gap / fade */
+    bool timed;                         /* Effect played by its time function */
+    struct effect_state state;          /* Progress of the running effect */
+    uint32_t t_ms;                      /* Effect time of the next frame */
+    uint32_t end_ms;                    /* Effect time the entry ends at */
+    uint64_t rate;                      /* Ticks per effect ms (32.32) */
+#if defined(CONFIG_LED_SHOW_FADE)
+    struct led_show_layer fade_out;     /* Outgoing effect of a cross-fade */
+    struct led_show_layer fade_in;      /* Incoming effect of a cross-fade */
+    uint16_t fade_ms;                   /* Length of the cross-fade */
+    uint16_t fade_elapsed_ms;           /* Cross-fade time done */
+#endif
+#if defined(CONFIG_LED_SHOW_LAYERS)
+    uint32_t layer_ms;                  /* Time of the overlay layers */
+#endif
+    struct frame_sched sched;           /* Absolute-deadline timeline */
+#if defined(CONFIG_LED_SHOW_ZONES)
+    struct led_frame leds;              /* LEDs of the zone */
+    uint16_t speed_pct;                 /* Zone tempo, 100 = show speed */
+    struct led_qframe frame;            /* Frame it shows, as levels */
+#endif
+};
+
+/**
+ * @brief A running show
+ *
+ * All state needed to resume the show lives here; there is no thread
+ * per show or per zone. A show renders into the single output queue, so
+ * only one show can be running at a time.
+ */
+struct led_show {
+    struct k_work_delayable work;       /* Frame timer + handler */
+    struct led_zone zones[LED_SHOW_MAX_ZONES]; /* Timelines, see led_zone */
+    uint8_t num_zones;                  /* Zones in use, at least 1 */
+#if defined(CONFIG_LED_SHOW_ZONES)
+    uint8_t heap[LED_SHOW_MAX_ZONES];   /* Zone indices, min-heap by deadline */
+#endif
+    atomic_ptr_t pending;               /* Replacement, see set_playlist */
+    struct k_event ctl;                 /* Requests and status events */
+    bool stopped;                       /* Stopped by LED_SHOW_CTL_STOP */
+    bool off_pending;                   /* Stopped, all-off not queued yet */
+    bool mark_pending;                  /* Next frame carries switch stamp */
+    atomic_t speed_pct;                 /* Tempo, LED_SHOW_SPEED_NOMINAL = 1x */
+    uint32_t req_cycles;                /* Cycle count at the last switch */
+    uint32_t announce_us;               /* Renderer time, last effect log */
+    uint32_t announce_max_us;           /* Largest of these */
+};
+
+/**
+ * @brief Check that a playlist can be played
+ *
+ * @return 0 if valid, -EINVAL if it is empty, has a zero cycle count or
+ *         tempo, or an effect whose cycle lasts 0 ms, -ENOENT if an effect
+ *         is not built into the image, or an error of led_layers_validate()
+ */
+int led_playlist_validate(const struct led_playlist *playlist);
+
+/**
+ * @brief Prepare a show
+ *
+ * @param show     Show to initialize
+ * @param playlist Valid playlist, must stay valid while it is played
+ */
+void led_show_init(struct led_show *show, const struct led_playlist *playlist);
+
+/**
+ * @brief Give some LEDs a zone of their own
+ *
+ * The zone plays @p playlist on a timeline of its own, at @p speed_pct of
+ * the show speed, and its LEDs leave the zones they were in. Control
+ * requests apply to every zone. Call between led_show_init() and
+ * led_show_start().
+ *
+ * @param show      Show to change
+ * @param leds      LEDs of the zone
+ * @param playlist  Valid playlist, must stay valid while it is played
+ * @param speed_pct Zone tempo in percent of the show speed
+ *
+ * @return Index of the new zone, -ENOTSUP without CONFIG_LED_SHOW_ZONES,
+ *         -ENOSPC if all zones are in use, -EINVAL if @p speed_pct is 0,
+ *         or an error of led_playlist_validate()
+ */
+int led_show_add_zone(struct led_show *show, const struct led_frame *leds,
+                      const struct led_playlist *playlist, uint16_t speed_pct);
+
+/**
+ * @brief Replace the playlist of a show, without stopping it
+ *
+ * The show renderer takes the new playlist over as the playlist of zone
+ * 0 and, if running, starts its first entry at once. The previous
+ * playlist is no longer used once this returns 0. Must not be called
+ * from the show work queue itself.
+ *
+ * @param show     Show to change
+ * @param playlist New playlist, must stay valid while it is played
+ * @param timeout  How long to wait for the renderer to take it over
+ *
+ * @return 0 once taken over, -EAGAIN if not taken over in time (the
+ *         request is withdrawn, @p playlist is not used), or an error of
+ *         led_playlist_validate()
+ */
+int led_show_set_playlist(struct led_show *show,
+                          const struct led_playlist *playlist,
+                          k_timeout_t timeout);
+
+/**
+ * @brief Current playlist of a show (zone 0)
+ */
+const struct led_playlist *led_show_get_playlist(const struct led_show *show);
+
+/**
+ * @brief Start (or restart) a show from its first entry
+ *
+ * Returns immediately; frames are produced on the show work queue.
+ *
+ * @param show Show to start
+ */
+void led_show_start(struct led_show *show);
+
+/**
+ * @brief Post control requests to a show
+ *
+ * Safe to call from an ISR. For LED_SHOW_CTL_NEXT / _PREV the time from
+ * this call to the commit of the first frame of the new effect is
+ * recorded in the output queue statistics (switch_last_us/switch_max_us).
+ *
+ * @param show     Show to control
+ * @param requests LED_SHOW_CTL_* bits
+ */
+void led_show_control(struct led_show *show, uint32_t requests);
+
+/**
+ * @brief Wait for show status events
+ *
+ * @param show    Show to observe
+ * @param events  LED_SHOW_EVT_* bits, any of which ends the wait
+ * @param timeout How long to wait
+ *
+ * @return The matching events, 0 on timeout
+ */
+uint32_t led_show_wait(struct led_show *show, uint32_t events,
+                       k_timeout_t timeout);
+
+/**
+ * @brief Stop a show and wait until its LEDs are off
+ *
+ * Must not be called from the show work queue itself.
+ *
+ * @param show    Show to stop
+ * @param timeout How long to wait for the show to acknowledge
+ *
+ * @return 0 once stopped, -EAGAIN on timeout
+ */
+int led_show_stop(struct led_show *show, k_timeout_t timeout);
+
+/**
+ * @brief Change the show tempo
+ *
+ * Applies immediately: frames rendered ahead at the old speed are
+ * dropped and the next frame is produced right away at the new speed.
+ * Safe to call from an ISR.
+ *
+ * @param show      Running show
+ * @param speed_pct Speed in percent of nominal (200 = twice as fast)
+ */
+void led_show_set_speed(struct led_show *show, uint32_t speed_pct);
+
+/**
+ * @brief Change the tempo all shows are played at
+ *
+ * Sets the global tempo (led_tempo.h) and applies it like
+ * led_show_set_speed(). Safe to call from an ISR.
+ *
+ * @param show Running show
+ * @param bpm  Tempo in hundredths of a BPM, see LED_TEMPO_BPM()
+ *
+ * @return 0 on success, -EINVAL if out of range
+ */
+int led_show_set_bpm(struct led_show *show, uint32_t bpm);
+
+/**
+ * @brief Tap the tempo
+ *
+ * See led_tempo_tap(); once a tempo is measured it is applied like
+ * led_show_set_bpm(). Safe to call from an ISR.
+ *
+ * @param show Running show
+ *
+ * @return As led_tempo_tap()
+ */
+int led_show_tap(struct led_show *show);
+
+#endif /* LED_SHOW_H_ */
@@ -0,0 +1,315 @@
+/*
+ * Addressable LED Strip Backend
+ *
+ * Description: Three pixel buffers in the driver's own struct led_rgb
+ *              layout are rotated: while the strip thread hands one to
+ *              led_strip_update_rgb() (which may clock it out over SPI
+ *              DMA directly from that memory, and may also overwrite it)
+ *              and another holds a frame waiting for it, the output thread
+ *              renders the next frame into the third. No intermediate
+ *              copy is made between the frame and the driver.
+ *
+ *              Only buffer indices change hands under the spinlock; the
+ *              pixels are rendered with it released, so a long strip
+ *              does not hold off other interrupts for the whole render.
+ *
+ *              The output thread never waits for the strip: a frame that
+ *              is not picked up before the next one arrives is replaced,
+ *              so a slow strip drops frames instead of delaying the show.
+ *
+ * License:     MIT
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/led_strip.h>
+
+#include "led_strip_out.h"
+
+#if defined(CONFIG_LED_SHOW_STRIP)
+
+#define STRIP_NODE      DT_ALIAS(led_strip)
+#define STRIP_LEN       DT_PROP(STRIP_NODE, chain_length)
+
+BUILD_ASSERT(STRIP_LEN <= LED_FRAME_MAX_LEDS,
+             "Strip is longer than CONFIG_LED_SHOW_MAX_LEDS");
+
+static const struct device *const strip = DEVICE_DT_GET(STRIP_NODE);
+
+/* Pixel buffers, passed to the driver as they are */
+static struct led_rgb pixels[3][STRIP_LEN];
+
+/*
+ * Buffer ownership, under "lock": "sending" is on the wire (owned by the
+ * strip thread), "ready" holds a rendered frame not picked up yet. Both
+ * are -1 when unused. The output thread (the only renderer) takes the
+ * remaining buffer, which neither of them can reach until it is published.
+ */
+static struct k_spinlock lock;
+static int8_t sending = -1;
+static int8_t ready = -1;
+
+static K_SEM_DEFINE(strip_sem, 0, 1);
+static bool available;
+static struct led_strip_out_stats stats;
+
+#if defined(CONFIG_LED_SHOW_LEVELS)
+/* Pixel per level, for per-LED levels */
+static struct led_rgb palette[UINT8_MAX + 1];
+#endif
+
+/**
+ * @brief Pixel of the strip color at a level
+ */
+static struct led_rgb strip_color(uint8_t level)
+{
+    /* Gamma 2, like the PWM and BAM backends */
+    uint32_t duty = ((uint32_t)level * level + 254) / 255;
+
+    return (struct led_rgb){
+        .r = (uint8_t)(((CONFIG_LED_SHOW_STRIP_COLOR >> 16) & 0xFF) *
+                       duty / 255),
+        .g = (uint8_t)(((CONFIG_LED_SHOW_STRIP_COLOR >> 8) & 0xFF) *
+                       duty / 255),
+        .b = (uint8_t)((CONFIG_LED_SHOW_STRIP_COLOR & 0xFF) * duty / 255),
+    };
+}
+
+/**
+ * @brief Render one or two frame layers into a pixel buffer
+ *
+ * @p b may be NULL for a plain frame. Words without a lit LED are cleared
+ * in one go.
+ */
+static void strip_render(struct led_rgb *px, const struct led_frame *a,
+                         uint8_t level_a, const struct led_frame *b,
+                         uint8_t level_b)
+{
+    /* Pixel per LED class, indexed by (in b) << 1 | (in a) */
+    const struct led_rgb color[4] = {
+        { 0 },
+        strip_color(level_a),
+        strip_color(level_b),
+        strip_color(led_frame_blend_level(level_a, level_b)),
+    };
+
+    for (size_t base = 0; base < STRIP_LEN; base += LED_FRAME_WORD_BITS) {
+        size_t w = base / LED_FRAME_WORD_BITS;
+        led_mask_t word_a = a->words[w];
+        led_mask_t word_b = (b != NULL) ? b->words[w] : 0;
+        size_t n = MIN(LED_FRAME_WORD_BITS, STRIP_LEN - base);
+
+        if ((word_a | word_b) == 0) {
+            memset(&px[base], 0, n * sizeof(px[0]));
+            continue;
+        }
+        for (size_t i = 0; i < n; i++) {
+            px[base + i] = color[(((word_b >> i) & 1U) << 1) |
+                                 ((word_a >> i) & 1U)];
+        }
+    }
+}
+
+/**
+ * @brief Strip thread: transfer every frame the output thread publishes
+ */
+static void strip_thread(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    for (;;) {
+        k_spinlock_key_t key;
+        uint32_t start;
+        int8_t buf;
+        int ret;
+
+        k_sem_take(&strip_sem, K_FOREVER);
+
+        key = k_spin_lock(&lock);
+        buf = ready;
+        ready = -1;
+        sending = buf;
+        k_spin_unlock(&lock, key);
+
+        if (buf < 0) {
+            continue;
+        }
+
+        start = k_cycle_get_32();
+        ret = led_strip_update_rgb(strip, pixels[buf], STRIP_LEN);
+
+        key = k_spin_lock(&lock);
+        sending = -1;
+        k_spin_unlock(&lock, key);
+
+        if (ret < 0) {
+            stats.errors++;
+        } else {
+            stats.transfers++;
+        }
+        stats.last_xfer_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+    }
+}
+
+K_THREAD_DEFINE(led_strip_tid, CONFIG_LED_SHOW_STRIP_STACK_SIZE,
+                strip_thread, NULL, NULL, NULL,
+                CONFIG_LED_SHOW_STRIP_PRIORITY, 0, 0);
+
+int led_strip_out_init(void)
+{
+    static const struct led_frame off;
+
+    if (!device_is_ready(strip)) {
+        return -ENODEV;
+    }
+
+    /* Effects must render as many frame words as the strip shows */
+    led_frame_reserve(STRIP_LEN);
+
+#if defined(CONFIG_LED_SHOW_LEVELS)
+    for (size_t i = 0; i < ARRAY_SIZE(palette); i++) {
+        palette[i] = strip_color((uint8_t)i);
+    }
+#endif
+
+    available = true;
+    led_strip_out_show(&off, 0);
+
+    return 0;
+}
+
+bool led_strip_out_available(void)
+{
+    return available;
+}
+
+/**
+ * @brief Take the buffer that is neither being sent nor waiting
+ *
+ * @param buf Set to the index of the buffer, for strip_publish()
+ *
+ * @return The buffer to render into, or NULL if there is no strip
+ */
+static struct led_rgb *strip_begin(int8_t *buf)
+{
+    k_spinlock_key_t key;
+    int8_t b = 0;
+
+    if (!available) {
+        return NULL;
+    }
+
+    key = k_spin_lock(&lock);
+    while (b == sending || b == ready) {
+        b++;
+    }
+    k_spin_unlock(&lock, key);
+
+    *buf = b;
+    return pixels[b];
+}
+
+/**
+ * @brief Hand a rendered buffer to the strip thread
+ *
+ * A frame still waiting is replaced; its buffer is free for the next
+ * render.
+ */
+static void strip_publish(int8_t buf)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    if (ready >= 0) {
+        stats.coalesced++;
+    }
+    ready = buf;
+    k_spin_unlock(&lock, key);
+
+    k_sem_give(&strip_sem);
+}
+
+void led_strip_out_show(const struct led_frame *frame, uint8_t level)
+{
+    int8_t buf;
+    struct led_rgb *px = strip_begin(&buf);
+
+    if (px != NULL) {
+        strip_render(px, frame, level, NULL, 0);
+        strip_publish(buf);
+    }
+}
+
+void led_strip_out_show_blend(const struct led_frame *a, uint8_t level_a,
+                              const struct led_frame *b, uint8_t level_b)
+{
+    int8_t buf;
+    struct led_rgb *px = strip_begin(&buf);
+
+    if (px != NULL) {
+        strip_render(px, a, level_a, b, level_b);
+        strip_publish(buf);
+    }
+}
+
+#if defined(CONFIG_LED_SHOW_LEVELS)
+void led_strip_out_show_levels(const uint8_t *levels, size_t count)
+{
+    int8_t buf;
+    struct led_rgb *px = strip_begin(&buf);
+
+    if (px != NULL) {
+        for (size_t i = 0; i < STRIP_LEN; i++) {
+            px[i] = palette[(i < count) ? levels[i] : 0];
+        }
+        strip_publish(buf);
+    }
+}
+#endif
+
+void led_strip_out_get_stats(struct led_strip_out_stats *out)
+{
+    *out = stats;
+}
+
+#else /* !CONFIG_LED_SHOW_STRIP */
+
+int led_strip_out_init(void)
+{
+    return -ENODEV;
+}
+
+bool led_strip_out_available(void)
+{
+    return false;
+}
+
+void led_strip_out_show(const struct led_frame *frame, uint8_t level)
+{
+    ARG_UNUSED(frame);
+    ARG_UNUSED(level);
+}
+
+void led_strip_out_show_blend(const struct led_frame *a, uint8_t level_a,
+                              const struct led_frame *b, uint8_t level_b)
+{
+    ARG_UNUSED(a);
+    ARG_UNUSED(level_a);
+    ARG_UNUSED(b);
+    ARG_UNUSED(level_b);
+}
+
+void led_strip_out_show_levels(const uint8_t *levels, size_t count)
+{
+    ARG_UNUSED(levels);
+    ARG_UNUSED(count);
+}
+
+void led_strip_out_get_stats(struct led_strip_out_stats *out)
+{
+    *out = (struct led_strip_out_stats){ 0 };
+}
+
+#endif /* CONFIG_LED_SHOW_STRIP */
@@ -0,0 +1,85 @@
+/*
+ * Addressable LED Strip Backend
+ *
+ * Description: Shows the frames on a WS2812/APA102-class strip through
+ *              the Zephyr led_strip API (devicetree alias "led-strip").
+ *              Pixel N mirrors LED N of the frame, lit in
+ *              CONFIG_LED_SHOW_STRIP_COLOR at the frame's level.
+ *
+ * License:     MIT
+ */
+
+#ifndef LED_STRIP_OUT_H_
+#define LED_STRIP_OUT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "led_frame.h"
+
+/**
+ * @brief Strip output counters
+ */
+struct led_strip_out_stats {
+    uint32_t transfers;     /* led_strip_update_rgb() calls completed */
+    uint32_t coalesced;     /* Frames replaced before they were sent */
+    uint32_t errors;        /* Transfers the driver rejected */
+    uint32_t last_xfer_us;  /* Duration of the last transfer */
+};
+
+/**
+ * @brief Check the strip and blank it
+ *
+ * @return 0 on success, -ENODEV if there is no usable strip
+ */
+int led_strip_out_init(void);
+
+/**
+ * @brief Whether frames are mirrored to a strip
+ *
+ * @return true once led_strip_out_init() succeeded
+ */
+bool led_strip_out_available(void);
+
+/**
+ * @brief Render a frame for the strip
+ *
+ * Renders into the pixel buffer that is not being transferred and wakes
+ * the strip thread; returns without waiting for the transfer. If the
+ * previous frame has not been picked up yet, it is replaced. Safe to
+ * call from an ISR.
+ *
+ * @param frame LEDs that are ON
+ * @param level Brightness of the ON LEDs, 0 to 255
+ */
+void led_strip_out_show(const struct led_frame *frame, uint8_t level);
+
+/**
+ * @brief Render two frames over each other for the strip
+ *
+ * As led_strip_out_show(), each layer at its own level; pixels lit in
+ * both get led_frame_blend_level(). Safe to call from an ISR.
+ */
+void led_strip_out_show_blend(const struct led_frame *a, uint8_t level_a,
+                              const struct led_frame *b, uint8_t level_b);
+
+/**
+ * @brief Render per-LED levels for the strip
+ *
+ * As led_strip_out_show(), every pixel at its own level; pixels past
+ * @p count are off. Needs CONFIG_LED_SHOW_LEVELS. Safe to call from an
+ * ISR.
+ *
+ * @param levels Brightness per LED, 0 to 255
+ * @param count  Number of entries in @p levels
+ */
+void led_strip_out_show_levels(const uint8_t *levels, size_t count);
+
+/**
+ * @brief Read the strip counters
+ *
+ * @param stats Filled with the current counters
+ */
+void led_strip_out_get_stats(struct led_strip_out_stats *stats);
+
+#endif /* LED_STRIP_OUT_H_ */
@@ -0,0 +1,103 @@
+/*
+ * Show Tempo
+ *
+ * Description: The rate is computed once per tempo change, as whole ticks
+ *              plus a 32-bit fraction per nominal millisecond; the frame
+ *              scheduler adds it up with the fraction carried from frame
+ *              to frame, so the rounding left is 2^-32 tick per frame.
+ *
+ * License:     MIT
+ */
+
+#include <errno.h>
+#include <zephyr/kernel.h>
+
+#include "led_tempo.h"
+
+/* ticks/ms = (ticks/s / 1000) * (REF_BPM / bpm), as 32.32 fixed point */
+#define TEMPO_NUM ((uint64_t)CONFIG_SYS_CLOCK_TICKS_PER_SEC *             \
+                   LED_TEMPO_BPM(LED_TEMPO_REF_BPM))
+#define TEMPO_DEN(_bpm) (1000ULL * (_bpm))
+#define TEMPO_RATE(_bpm)                                                  \
+    (((TEMPO_NUM / TEMPO_DEN(_bpm)) << 32) +                              \
+     (((TEMPO_NUM % TEMPO_DEN(_bpm)) << 32) / TEMPO_DEN(_bpm)))
+
+static struct k_spinlock lock;
+static uint32_t tempo_bpm = LED_TEMPO_BPM(CONFIG_LED_SHOW_BPM);
+static uint64_t tempo_rate = TEMPO_RATE(LED_TEMPO_BPM(CONFIG_LED_SHOW_BPM));
+
+/* Ring of the last taps; the next one goes to num_taps % LED_TEMPO_TAPS */
+static k_ticks_t taps[LED_TEMPO_TAPS];
+static uint32_t num_taps;       /* Taps of the running series */
+
+int led_tempo_set_bpm(uint32_t bpm)
+{
+    k_spinlock_key_t key;
+
+    if (bpm < LED_TEMPO_MIN || bpm > LED_TEMPO_MAX) {
+        return -EINVAL;
+    }
+
+    key = k_spin_lock(&lock);
+    tempo_bpm = bpm;
+    tempo_rate = TEMPO_RATE(bpm);
+    k_spin_unlock(&lock, key);
+
+    return 0;
+}
+
+uint32_t led_tempo_get_bpm(void)
+{
+    return tempo_bpm;
+}
+
+int led_tempo_tap(void)
+{
+    k_ticks_t timeout =
+        (k_ticks_t)k_ms_to_ticks_ceil64(LED_TEMPO_TAP_TIMEOUT_MS);
+    k_ticks_t now = k_uptime_ticks();
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    k_ticks_t last = taps[(num_taps + LED_TEMPO_TAPS - 1) % LED_TEMPO_TAPS];
+    uint32_t intervals;
+    uint64_t span;
+    uint64_t bpm;
+
+    if (num_taps == 0 || now - last > timeout) {
+        num_taps = 0;
+    }
+    taps[num_taps % LED_TEMPO_TAPS] = now;
+    num_taps++;
+
+    if (num_taps < 2) {
+        k_spin_unlock(&lock, key);
+        return 0;
+    }
+
+    /* Mean interval from the oldest tap still in the ring */
+    intervals = MIN(num_taps, LED_TEMPO_TAPS) - 1;
+    span = now - taps[(num_taps - 1 - intervals) % LED_TEMPO_TAPS];
+    k_spin_unlock(&lock, key);
+
+    if (span == 0) {
+        return -EINVAL;
+    }
+
+    /* Hundredths of a BPM: 60 s * 100 per mean interval */
+    bpm = (uint64_t)CONFIG_SYS_CLOCK_TICKS_PER_SEC * 6000U * intervals / span;
+
+    if (bpm > LED_TEMPO_MAX || led_tempo_set_bpm((uint32_t)bpm) < 0) {
+        return -EINVAL;
+    }
+
+    return (int)bpm;
+}
+
+uint64_t led_tempo_ticks_per_ms(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    uint64_t rate = tempo_rate;
+
+    k_spin_unlock(&lock, key);
+
+    return rate;
+}
@@ -0,0 +1,95 @@
+/*
+ * Show Tempo
+ *
+ * Description: Global tempo of the show in beats per minute. Effect and
+ *              playlist durations are nominal milliseconds at
+ *              LED_TEMPO_REF_BPM, so an effect step of 50 ms is an eighth
+ *              of a beat. The tempo engine turns nominal milliseconds into
+ *              kernel ticks for the current BPM, as a 32.32 fixed-point
+ *              rate, so tempos such as 128 BPM whose steps are not whole
+ *              milliseconds or ticks are kept exactly over hours.
+ *
+ *              The tempo is set directly or tapped in: the beat length is
+ *              the mean interval of the last LED_TEMPO_TAPS taps.
+ *
+ * License:     MIT
+ */
+
+#ifndef LED_TEMPO_H_
+#define LED_TEMPO_H_
+
+#include <stdint.h>
+
+/* ============================================================================
+ * BEATS
+ * ============================================================================
+ */
+
+/** Tempo at which nominal durations are real milliseconds */
+#define LED_TEMPO_REF_BPM 150
+
+/** Nominal length of one beat */
+#define LED_TEMPO_BEAT_MS (60000 / LED_TEMPO_REF_BPM)
+
+/**
+ * @brief Nominal duration of a fraction of a beat
+ *
+ * @param _num Numerator, e.g. 1
+ * @param _den Denominator, e.g. 8 for an eighth of a beat
+ */
+#define LED_TEMPO_BEATS_MS(_num, _den) (LED_TEMPO_BEAT_MS * (_num) / (_den))
+
+/** Tempo in hundredths of a BPM, e.g. LED_TEMPO_BPM(128) */
+#define LED_TEMPO_BPM(_bpm) ((uint32_t)((_bpm) * 100))
+
+/* Accepted tempo range */
+#define LED_TEMPO_MIN LED_TEMPO_BPM(20)
+#define LED_TEMPO_MAX LED_TEMPO_BPM(400)
+
+/** Taps averaged by led_tempo_tap() */
+#define LED_TEMPO_TAPS 8
+
+/** A tap this long after the previous one starts a new measurement */
+#define LED_TEMPO_TAP_TIMEOUT_MS 2000
+
+/* ============================================================================
+ * API
+ * ============================================================================
+ */
+
+/**
+ * @brief Set the tempo
+ *
+ * Safe to call from an ISR. Applies to deadlines computed from now on;
+ * frames already rendered ahead keep the old tempo.
+ *
+ * @param bpm Tempo in hundredths of a BPM, see LED_TEMPO_BPM()
+ *
+ * @return 0 on success, -EINVAL outside LED_TEMPO_MIN..LED_TEMPO_MAX
+ */
+int led_tempo_set_bpm(uint32_t bpm);
+
+/**
+ * @brief Current tempo, in hundredths of a BPM
+ */
+uint32_t led_tempo_get_bpm(void);
+
+/**
+ * @brief Record a tap of the tempo input
+ *
+ * Safe to call from an ISR. From the second tap of a series on, the tempo
+ * is set to the mean interval of the last LED_TEMPO_TAPS taps.
+ *
+ * @return The new tempo, 0 if this tap started a series, or -EINVAL if
+ *         the taps are out of the tempo range (tempo unchanged)
+ */
+int led_tempo_tap(void);
+
+/**
+ * @brief Kernel ticks per nominal millisecond at the current tempo
+ *
+ * @return Rate in 32.32 fixed point
+ */
+uint64_t led_tempo_ticks_per_ms(void);
+
+#endif /* LED_TEMPO_H_ */
@@ -0,0 +1,305 @@
+/*
+ * LED Bytecode VM
+ *
+ * Description: One switch per opcode, dispatched on the high nibble.
+ *              After a frame is produced the interpreter keeps running
+ *              the opcodes that do not show anything (SET, ADD, NEXT,
+ *              TEMPO, ...) up to the next one that does, so it knows
+ *              whether the frame just produced was the last of a cycle.
+ *
+ * License:     MIT
+ */
+
+#include <errno.h>
+#include <zephyr/kernel.h>
+
+#include "effects.h"
+#include "led_pattern.h"
+#include "led_vm.h"
+
+/* Opcodes run for one frame before a program is taken as stuck */
+#define VM_MAX_OPS 64
+
+/**
+ * @brief Whether @p op is followed by an operand byte
+ */
+static bool vm_has_operand(uint8_t op)
+{
+    switch (op & 0xF0) {
+    case LED_VM_OP_LOOP:
+    case LED_VM_OP_FADE:
+    case LED_VM_OP_TEMPO:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Render the frame described by the registers
+ */
+static void vm_render(struct effect_state *state, struct led_step *out)
+{
+    if (state->vm.flags & LED_VM_F_RANDOM) {
+        led_pattern_random(out->frame, ++state->frame);
+    } else {
+        led_frame_fill(out->frame, LED_PATTERN_TILE(state->vm.mask));
+    }
+}
+
+/**
+ * @brief One frame of FADE: a dimmed level, or soft PWM without dimming
+ *
+ * @return true once the last step of the ramp is out
+ */
+static bool vm_fade(struct effect_state *state, struct led_step *out,
+                    uint8_t down, uint8_t steps, uint32_t tick_ms)
+{
+    struct led_vm_regs *vm = &state->vm;
+    uint32_t step = down ? (steps - vm->fade_step) : vm->fade_step;
+    uint32_t level = step * LED_LEVEL_FULL / steps;
+
+    vm_render(state, out);
+    out->level = LED_LEVEL_FULL;
+
+    if (led_output_has_dimming()) {
+        out->level = (uint8_t)level;
+        out->duration_ms = tick_ms;
+    } else if (!(vm->flags & LED_VM_F_OFF)) {
+        /* Soft PWM: ON part of the tick, OFF part on the next call */
+        out->duration_ms = tick_ms * level / LED_LEVEL_FULL;
+        vm->flags |= LED_VM_F_OFF;
+        return false;
+    } else {
+        led_frame_clear(out->frame);
+        out->duration_ms = tick_ms - tick_ms * level / LED_LEVEL_FULL;
+        vm->flags &= ~LED_VM_F_OFF;
+    }
+
+    if (++vm->fade_step > steps) {
+        vm->fade_step = 0;
+        return true;
+    }
+
+    return false;
+}
+
+bool led_vm_step(const struct led_effect *effect, struct effect_state *state,
+                 struct led_step *out)
+{
+    const struct led_vm_program *program = effect->data;
+    const uint8_t *code = program->code;
+    struct led_vm_regs *vm = &state->vm;
+    uint32_t tick_ms = vm->tick_ms ? vm->tick_ms : LED_VM_TICK_MS;
+    bool shown = false;
+
+    for (int ops = 0; ops < VM_MAX_OPS; ops++) {
+        uint8_t op = (vm->pc < program->len) ? code[vm->pc] : LED_VM_OP_END;
+        uint8_t imm = op & 0xF;
+        uint8_t arg = 0;
+
+        if (vm_has_operand(op)) {
+            /* Operand cut off by the end of the program: end it there */
+            if (vm->pc + 1 >= program->len) {
+                op = LED_VM_OP_END;
+            } else {
+                arg = code[vm->pc + 1];
+            }
+        }
+
+        switch (op & 0xF0) {
+        case LED_VM_OP_SET:
+            vm->mask = imm;
+            vm->flags &= ~LED_VM_F_RANDOM;
+            vm->pc++;
+            break;
+
+        case LED_VM_OP_ADD:
+            vm->mask = (vm->mask + imm) & 0xF;
+            vm->flags &= ~LED_VM_F_RANDOM;
+            vm->pc++;
+            break;
+
+        case LED_VM_OP_RAND:
+            vm->flags |= LED_VM_F_RANDOM;
+            vm->pc++;
+            break;
+
+        case LED_VM_OP_LOOP:
+            vm->loop_left = arg;
+            vm->pc += 2;
+            vm->loop_pc = vm->pc;
+            break;
+
+        case LED_VM_OP_NEXT:
+            if (vm->loop_left > 1) {
+                vm->loop_left--;
+                vm->pc = vm->loop_pc;
+            } else {
+                vm->loop_left = 0;
+                vm->pc++;
+            }
+            break;
+
+        case LED_VM_OP_TEMPO:
+            vm->tick_ms = arg;
+            tick_ms = arg ? arg : LED_VM_TICK_MS;
+            vm->pc += 2;
+            break;
+
+        case LED_VM_OP_SHOW:
+            if (shown) {
+                return false;
+            }
+            vm->mask = imm;
+            vm->flags &= ~LED_VM_F_RANDOM;
+            imm = 1;
+            __fallthrough;
+
+        case LED_VM_OP_WAIT:
+            if (shown) {
+                return false;
+            }
+            vm_render(state, out);
+            out->level = LED_LEVEL_FULL;
+            out->duration_ms = (imm ? imm : 16) * tick_ms;
+            vm->pc++;
+            shown = true;
+            break;
+
+        case LED_VM_OP_FADE:
+            if (shown) {
+                return false;
+            }
+            if (vm_fade(state, out, imm, MAX(arg, 1), tick_ms)) {
+                vm->pc += 2;
+            }
+            shown = true;
+            break;
+
+        case LED_VM_OP_CALL: {
+            const struct led_effect *callee = led_effect_get(imm);
+
+            /* Rejected by led_vm_validate(); skipped if it slips through */
+            if (callee == NULL || callee->step == led_vm_step) {
+                vm->pc++;
+                break;
+            }
+            if (shown) {
+                return false;
+            }
+            if (!(vm->flags & LED_VM_F_CALL)) {
+                /* The callee starts from a zeroed state of its own */
+                state->frame = 0;
+                state->aux = 0;
+                state->reserved = 0;
+                vm->flags |= LED_VM_F_CALL;
+            }
+            if (callee->step(callee, state, out)) {
+                vm->flags &= ~LED_VM_F_CALL;
+                vm->pc++;
+            }
+            shown = true;
+            break;
+        }
+
+        case LED_VM_OP_END:
+        default:
+            vm->pc = 0;
+            if (shown) {
+                return true;
+            }
+            break;
+        }
+    }
+
+    /* Stuck without a frame: show the current one for a tick */
+    if (!shown) {
+        vm_render(state, out);
+        out->level = LED_LEVEL_FULL;
+        out->duration_ms = tick_ms;
+        return true;
+    }
+
+    return false;
+}
+
+int led_vm_validate(const uint8_t *code, size_t len)
+{
+    bool in_loop = false;
+    bool shows = false;
+    size_t pc = 0;
+
+    if (len == 0 || len > UINT8_MAX || code[len - 1] != LED_VM_OP_END) {
+        return -EINVAL;
+    }
+
+    while (pc < len) {
+        uint8_t op = code[pc];
+        uint8_t imm = op & 0xF;
+        const struct led_effect *callee;
+
+        /* Operand byte of the two-byte opcodes */
+        if (vm_has_operand(op) && (pc + 1 >= len || code[pc + 1] == 0)) {
+            return -EINVAL;
+        }
+
+        switch (op & 0xF0) {
+        case LED_VM_OP_END:
+            if (in_loop) {
+                return -EINVAL;
+            }
+            pc++;
+            break;
+        case LED_VM_OP_SET:
+        case LED_VM_OP_ADD:
+        case LED_VM_OP_RAND:
+            pc++;
+            break;
+        case LED_VM_OP_WAIT:
+        case LED_VM_OP_SHOW:
+            shows = true;
+            pc++;
+            break;
+        case LED_VM_OP_LOOP:
+            if (in_loop) {
+                return -EINVAL;
+            }
+            in_loop = true;
+            pc += 2;
+            break;
+        case LED_VM_OP_NEXT:
+            if (!in_loop) {
+                return -EINVAL;
+            }
+            in_loop = false;
+            pc++;
+            break;
+        case LED_VM_OP_FADE:
+            if (imm > 1) {
+                return -EINVAL;
+            }
+            shows = true;
+            pc += 2;
+            break;
+        case LED_VM_OP_CALL:
+            callee = led_effect_get(imm);
+            if (callee == NULL) {
+                return -ENOENT;
+            }
+            if (callee->step == led_vm_step) {
+                return -EINVAL;
+            }
+            shows = true;
+            pc++;
+            break;
+        case LED_VM_OP_TEMPO:
+            pc += 2;
+            break;
+        default:
+            return -EINVAL;
+        }
+    }
+
+    return shows ? 0 : -EINVAL;
+}
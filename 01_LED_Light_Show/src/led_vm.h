@@ -0,0 +1,121 @@
+/*
+ * LED Bytecode VM
+ *
+ * Description: Light shows as a few bytes of bytecode instead of C.
+ *              A program is a byte string played by led_vm_step(), the
+ *              step function of every bytecode effect, with all of its
+ *              registers in struct effect_state: no heap, no stack of its
+ *              own. Programs are plain data, so they can live in flash or
+ *              be checked with led_vm_validate() and loaded at runtime.
+ *
+ *              Every opcode is one byte: the operation in the high nibble
+ *              and a 4-bit immediate in the low nibble. LOOP, FADE and
+ *              TEMPO take one more byte.
+ *
+ * License:     MIT
+ */
+
+#ifndef LED_VM_H_
+#define LED_VM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "led_effect.h"
+
+/* ============================================================================
+ * INSTRUCTION SET
+ * ============================================================================
+ * The frame is one 4-LED group mask repeated along the LED set, as with
+ * frame tables (led_pattern.h), or a random frame after RAND. Times are
+ * in ticks of TEMPO milliseconds.
+ */
+#define LED_VM_OP_END   0x00    /* End of one cycle, start over */
+#define LED_VM_OP_SET   0x10    /* SET m: group mask = m, full level */
+#define LED_VM_OP_WAIT  0x20    /* WAIT n: show the frame n ticks (0 = 16) */
+#define LED_VM_OP_SHOW  0x30    /* SHOW m: SET m, then WAIT 1 */
+#define LED_VM_OP_ADD   0x40    /* ADD n: group mask += n (mod 16) */
+#define LED_VM_OP_LOOP  0x50    /* LOOP, n: run the body up to NEXT n times */
+#define LED_VM_OP_NEXT  0x60    /* End of the LOOP body */
+#define LED_VM_OP_RAND  0x70    /* Random frame, see led_pattern_random() */
+#define LED_VM_OP_FADE  0x80    /* FADE d, s: ramp up (d=0) or down (d=1) */
+#define LED_VM_OP_CALL  0x90    /* CALL id: one cycle of effect id (< 16) */
+#define LED_VM_OP_TEMPO 0xA0    /* TEMPO, ms: tick length from here on */
+
+/** Tick length until the first TEMPO */
+#define LED_VM_TICK_MS 10
+
+/* Program building blocks */
+#define VM_END          LED_VM_OP_END
+#define VM_SET(_m)      (LED_VM_OP_SET | ((_m) & 0xF))
+#define VM_WAIT(_n)     (LED_VM_OP_WAIT | ((_n) & 0xF))
+#define VM_SHOW(_m)     (LED_VM_OP_SHOW | ((_m) & 0xF))
+#define VM_ADD(_n)      (LED_VM_OP_ADD | ((_n) & 0xF))
+#define VM_LOOP(_n)     LED_VM_OP_LOOP, (_n)        /* n = 1 to 255 */
+#define VM_NEXT         LED_VM_OP_NEXT
+#define VM_RAND         LED_VM_OP_RAND
+/* s = 1 to 255: s + 1 frames, from 0 to full (UP) or full to 0 (DOWN) */
+#define VM_FADE_UP(_s)  LED_VM_OP_FADE, (_s)
+#define VM_FADE_DOWN(_s) (LED_VM_OP_FADE | 1), (_s)
+#define VM_CALL(_id)    (LED_VM_OP_CALL | ((_id) & 0xF))
+#define VM_TEMPO(_ms)   LED_VM_OP_TEMPO, (_ms)      /* ms = 1 to 255 */
+
+/* Flags of struct led_vm_regs */
+#define LED_VM_F_RANDOM BIT(0)  /* Frame comes from RAND, not the mask */
+#define LED_VM_F_OFF    BIT(1)  /* Soft-PWM FADE: OFF part of the step next */
+#define LED_VM_F_CALL   BIT(2)  /* Inside a CALL */
+
+/**
+ * @brief A bytecode program
+ */
+struct led_vm_program {
+    const uint8_t *code;    /* Ends with VM_END */
+    uint8_t len;            /* Bytes in @p code */
+};
+
+/**
+ * @brief Define a program from VM_* building blocks
+ *
+ * @param _var Variable name of the resulting struct led_vm_program
+ * @param ...  Opcodes, ending with VM_END
+ */
+#define LED_VM_PROGRAM_DEFINE(_var, ...)                                \
+    static const uint8_t _var##_code[] = { __VA_ARGS__ };               \
+    BUILD_ASSERT(sizeof(_var##_code) <= UINT8_MAX,                      \
+                 "VM program too long");                                \
+    static const struct led_vm_program _var = {                         \
+        .code = _var##_code,                                            \
+        .len = sizeof(_var##_code),                                     \
+    }
+
+/* ============================================================================
+ * API
+ * ============================================================================
+ */
+
+/**
+ * @brief Step function of bytecode effects
+ *
+ * @p effect->data is the struct led_vm_program to play. Runs opcodes up
+ * to the next frame; a cycle ends at VM_END. The program must pass
+ * led_vm_validate(); a missing operand ends the cycle. See
+ * led_effect_step_t.
+ */
+bool led_vm_step(const struct led_effect *effect, struct effect_state *state,
+                 struct led_step *out);
+
+/**
+ * @brief Check a program before playing it
+ *
+ * A CALL is checked against the effect registry, so call this once the
+ * effects are registered (after the APPLICATION level 0 SYS_INITs).
+ *
+ * @return 0 if valid; -EINVAL for an unknown opcode, a missing or zero
+ *         operand, an unbalanced or nested LOOP, a CALL of another
+ *         bytecode effect, a program longer than 255 bytes or one that
+ *         does not end with VM_END or never shows a frame; -ENOENT for a
+ *         CALL of an effect not built in
+ */
+int led_vm_validate(const uint8_t *code, size_t len);
+
+#endif /* LED_VM_H_ */
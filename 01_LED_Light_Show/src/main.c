@@ -16,337 +16,223 @@
  *   - Zephyr GPIO API: https://docs.zephyrproject.org/latest/hardware/peripherals/gpio.html
  */
 
-#include <stdio.h>
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/gpio.h>
+#include <zephyr/logging/log.h>
+
+#include "buttons.h"
+#include "effects.h"
+#include "led_frame.h"
+#include "led_output.h"
+#include "led_show.h"
+#include "led_tempo.h"
+#include "show_shell.h"
+
+LOG_MODULE_REGISTER(main, CONFIG_LED_SHOW_LOG_LEVEL);
 
 /* ============================================================================
  * CONFIGURATION
  * ============================================================================
- * LED node definitions from DeviceTree.
- * These aliases (led0, led1, led2, led3) are defined in the board's .dts file.
- * For nRF5340 DK, they correspond to P0.28, P0.29, P0.30, P0.31
+ * The LED set is generated from DeviceTree: every enabled child of the
+ * "led-show-leds" chosen node, or of the first gpio-leds node (the
+ * board's "leds" node, P0.28 to P0.31 on the nRF5340 DK) when nothing
+ * is chosen. LEDs may span several GPIO ports and expanders (no BAM
+ * brightness on I2C or SPI expanders, see led_output.c). A board
+ * with only an LED strip (see led_strip_out.c) may have no GPIO LEDs.
  */
-#define LED0_NODE DT_ALIAS(led0)
-#define LED1_NODE DT_ALIAS(led1)
-#define LED2_NODE DT_ALIAS(led2)
-#define LED3_NODE DT_ALIAS(led3)
+#define LEDS_NODE LED_FRAME_LEDS_NODE
 
-#define NUM_LEDS 4
+#define LED_SPEC(node_id) GPIO_DT_SPEC_GET(node_id, gpios),
 
 /* 
  * GPIO specifications array for all LEDs.
  * GPIO_DT_SPEC_GET extracts the GPIO port, pin number, and flags
  * from the DeviceTree configuration.
  */
-static const struct gpio_dt_spec leds[NUM_LEDS] = {
-    GPIO_DT_SPEC_GET(LED0_NODE, gpios),
-    GPIO_DT_SPEC_GET(LED1_NODE, gpios),
-    GPIO_DT_SPEC_GET(LED2_NODE, gpios),
-    GPIO_DT_SPEC_GET(LED3_NODE, gpios),
+static const struct gpio_dt_spec leds[] = {
+#if DT_NODE_EXISTS(LEDS_NODE)
+    DT_FOREACH_CHILD_STATUS_OKAY(LEDS_NODE, LED_SPEC)
+#endif
 };
 
+#define NUM_LEDS ARRAY_SIZE(leds)
+
+BUILD_ASSERT(ARRAY_SIZE(leds) <= LED_FRAME_MAX_LEDS,
+             "More LEDs in devicetree than CONFIG_LED_SHOW_MAX_LEDS");
+
 /* ============================================================================
  * TIMING DEFINITIONS
  * ============================================================================
- * Adjust these values to change animation speed
+ * Effect frame timings live in effects/effect_defs.h. Pauses are given in
+ * beats too (see led_tempo.h): 5/4 and 5/2 beats are exactly 500 ms and
+ * 1 s at the 150 BPM reference, the original pause lengths.
  */
-#define FAST_DELAY_MS    50   /* Fast animations (sparkle, cascade) */
-#define MEDIUM_DELAY_MS  100  /* Medium animations (knight rider, binary) */
-#define SLOW_DELAY_MS    200  /* Slow animations (wave, converge) */
+#define GAP_DELAY_MS     LED_TEMPO_BEATS_MS(5, 4) /* Between two effects */
+#define LOOP_DELAY_MS    LED_TEMPO_BEATS_MS(5, 2) /* Before the restart */
+
+#if defined(CONFIG_LED_SHOW_FADE)
+#define FADE_MS          CONFIG_LED_SHOW_FADE_MS  /* Instead of the gap */
+#else
+#define FADE_MS          0
+#endif
 
 /* ============================================================================
- * UTILITY FUNCTIONS
+ * DEFAULT PLAYLIST
  * ============================================================================
- * Basic LED control functions used by all effects
+ * Every effect built into the image, in id order with its default cycle
+ * count (see effects.h), played in a loop by the show runner (see
+ * led_show.c). Filled at startup from the effect registry; the shell can
+ * replace it at runtime ("show playlist set").
  */
+static struct led_playlist_entry default_entries[LED_EFFECT_ID_COUNT];
+static struct led_playlist default_playlist = { .entries = default_entries };
+
+#if defined(CONFIG_LED_SHOW_LAYERS)
+/* Sparkle added over the show, breathe multiplied in as an envelope */
+static const struct led_layer default_layers[] = {
+    { .effect = LED_EFFECT_SPARKLE, .mode = LED_BLEND_ADD, .opacity = 64 },
+    { .effect = LED_EFFECT_BREATHE, .mode = LED_BLEND_MULTIPLY,
+      .opacity = 128 },
+};
+#endif
 
 /**
- * @brief Turn off all LEDs
- * 
- * Sets all 4 LEDs to inactive state (LOW)
+ * @brief Build the default playlist from the effect registry
  */
-static void all_leds_off(void)
+static void build_playlist(void)
 {
-    for (int i = 0; i < NUM_LEDS; i++) {
-        gpio_pin_set_dt(&leds[i], 0);
+    uint16_t count = 0;
+
+    for (unsigned int id = 0; id < LED_EFFECT_ID_COUNT; id++) {
+        const struct led_effect *effect = led_effect_get(id);
+
+        if (effect == NULL) {
+            continue;
+        }
+        default_entries[count++] = (struct led_playlist_entry){
+            .effect = (uint8_t)id,
+            .cycles = effect->cycles,
+            .tempo_pct = LED_SHOW_SPEED_NOMINAL,
+            .gap_ms = GAP_DELAY_MS,
+            .fade_ms = FADE_MS,
+        };
     }
-}
 
-/**
- * @brief Turn on all LEDs
- * 
- * Sets all 4 LEDs to active state (HIGH)
- */
-static void all_leds_on(void)
-{
-    for (int i = 0; i < NUM_LEDS; i++) {
-        gpio_pin_set_dt(&leds[i], 1);
+    /* Longer pause before the playlist restarts, no fade into it */
+    if (count > 0) {
+        default_entries[count - 1].gap_ms = LOOP_DELAY_MS;
+        default_entries[count - 1].fade_ms = 0;
     }
-}
 
-/**
- * @brief Set a specific LED state
- * 
- * @param index LED index (0-3)
- * @param state true = ON, false = OFF
- */
-static void set_led(int index, bool state)
-{
-    if (index >= 0 && index < NUM_LEDS) {
-        gpio_pin_set_dt(&leds[index], state ? 1 : 0);
+    default_playlist.num_entries = count;
+
+#if defined(CONFIG_LED_SHOW_LAYERS)
+    if (led_layers_validate(default_layers, ARRAY_SIZE(default_layers)) == 0) {
+        default_playlist.layers = default_layers;
+        default_playlist.num_layers = ARRAY_SIZE(default_layers);
+    } else {
+        LOG_WRN("Overlay layers need Sparkle and Breathe as C effects");
     }
+#endif
 }
 
+static struct led_show show;
+
+#if defined(CONFIG_LED_SHOW_ZONES)
 /* ============================================================================
- * LED EFFECTS
+ * LED ZONE
  * ============================================================================
- * Collection of visual effects for the 4 LEDs
+ * The upper half of the LEDs plays a playlist of its own, on its own
+ * timeline and at three quarters of the show speed, while the lower half
+ * plays the default playlist.
  */
+#define ZONE_SPEED_PCT 75
 
-/**
- * @brief Knight Rider Effect
- * 
- * Classic scanning LED effect, moving back and forth.
- * Pattern: [*---] -> [-*--] -> [--*-] -> [---*] -> [--*-] -> ...
- * 
- * @param cycles Number of complete back-and-forth cycles
- */
-static void effect_knight_rider(int cycles)
-{
-    printf("[Effect] Knight Rider\n");
-    
-    for (int c = 0; c < cycles; c++) {
-        /* Forward sweep: LED 0 to LED 3 */
-        for (int i = 0; i < NUM_LEDS; i++) {
-            all_leds_off();
-            set_led(i, true);
-            k_msleep(MEDIUM_DELAY_MS);
-        }
-        /* Backward sweep: LED 2 to LED 0 */
-        for (int i = NUM_LEDS - 2; i >= 0; i--) {
-            all_leds_off();
-            set_led(i, true);
-            k_msleep(MEDIUM_DELAY_MS);
-        }
-    }
-    all_leds_off();
-}
+static struct led_playlist_entry zone_entries[] = {
+    { .effect = LED_EFFECT_BREATHE, .tempo_pct = LED_SHOW_SPEED_NOMINAL },
+    { .effect = LED_EFFECT_SPARKLE, .tempo_pct = LED_SHOW_SPEED_NOMINAL,
+      .gap_ms = GAP_DELAY_MS },
+};
+static const struct led_playlist zone_playlist = {
+    .entries = zone_entries,
+    .num_entries = ARRAY_SIZE(zone_entries),
+};
 
 /**
- * @brief Wave Effect
- * 
- * Progressive fill and empty effect.
- * Fill:  [*---] -> [**--] -> [***-] -> [****]
- * Empty: [****] -> [-***] -> [--**] -> [---*] -> [----]
- * 
- * @param cycles Number of complete fill/empty cycles
+ * @brief Give the upper half of the LEDs a zone of its own
  */
-static void effect_wave(int cycles)
+static void add_zone(void)
 {
-    printf("[Effect] Wave\n");
-    
-    for (int c = 0; c < cycles; c++) {
-        /* Progressive fill from LED 0 to LED 3 */
-        for (int i = 0; i < NUM_LEDS; i++) {
-            set_led(i, true);
-            k_msleep(SLOW_DELAY_MS);
-        }
-        /* Progressive empty from LED 0 to LED 3 */
-        for (int i = 0; i < NUM_LEDS; i++) {
-            set_led(i, false);
-            k_msleep(SLOW_DELAY_MS);
-        }
-    }
-}
+    struct led_frame upper = { 0 };
+    int ret;
 
-/**
- * @brief Alternate Flash Effect
- * 
- * Alternates between even and odd LEDs.
- * Pattern: [*-*-] <-> [-*-*]
- * 
- * @param cycles Number of alternation cycles
- */
-static void effect_alternate_flash(int cycles)
-{
-    printf("[Effect] Alternate Flash\n");
-    
-    for (int c = 0; c < cycles; c++) {
-        /* Even LEDs ON (0, 2), Odd LEDs OFF (1, 3) */
-        set_led(0, true);
-        set_led(1, false);
-        set_led(2, true);
-        set_led(3, false);
-        k_msleep(SLOW_DELAY_MS);
-        
-        /* Odd LEDs ON (1, 3), Even LEDs OFF (0, 2) */
-        set_led(0, false);
-        set_led(1, true);
-        set_led(2, false);
-        set_led(3, true);
-        k_msleep(SLOW_DELAY_MS);
-    }
-    all_leds_off();
-}
+    for (size_t i = 0; i < ARRAY_SIZE(zone_entries); i++) {
+        const struct led_effect *effect =
+            led_effect_get(zone_entries[i].effect);
 
-/**
- * @brief Converge Effect
- * 
- * LEDs light from outside to inside and vice versa.
- * Pattern: [*--*] <-> [-**-]
- * 
- * @param cycles Number of convergence cycles
- */
-static void effect_converge(int cycles)
-{
-    printf("[Effect] Converge\n");
-    
-    for (int c = 0; c < cycles; c++) {
-        all_leds_off();
-        
-        /* Outer LEDs ON (0 and 3) */
-        set_led(0, true);
-        set_led(3, true);
-        k_msleep(SLOW_DELAY_MS);
-        
-        all_leds_off();
-        
-        /* Inner LEDs ON (1 and 2) */
-        set_led(1, true);
-        set_led(2, true);
-        k_msleep(SLOW_DELAY_MS);
+        zone_entries[i].cycles = (effect != NULL) ? effect->cycles : 0;
     }
-    all_leds_off();
-}
 
-/**
- * @brief Binary Counter Effect
- * 
- * Displays numbers 0-15 in binary using the 4 LEDs.
- * LED0 = bit 0 (LSB), LED3 = bit 3 (MSB)
- * 
- * Example: 5 (0101) = LED0 ON, LED1 OFF, LED2 ON, LED3 OFF
- * 
- * @param cycles Number of complete 0-15 count cycles
- */
-static void effect_binary_counter(int cycles)
-{
-    printf("[Effect] Binary Counter\n");
-    
-    for (int c = 0; c < cycles; c++) {
-        for (int count = 0; count < 16; count++) {
-            /* Extract each bit and set corresponding LED */
-            set_led(0, (count & 0x01) != 0);  /* Bit 0 */
-            set_led(1, (count & 0x02) != 0);  /* Bit 1 */
-            set_led(2, (count & 0x04) != 0);  /* Bit 2 */
-            set_led(3, (count & 0x08) != 0);  /* Bit 3 */
-            k_msleep(MEDIUM_DELAY_MS);
-        }
+    for (size_t i = NUM_LEDS / 2; i < NUM_LEDS; i++) {
+        upper.words[i / LED_FRAME_WORD_BITS] |= BIT(i % LED_FRAME_WORD_BITS);
     }
-    all_leds_off();
-}
 
-/**
- * @brief Sparkle Effect
- * 
- * Creates a pseudo-random twinkling pattern using a 
- * Linear Feedback Shift Register (LFSR) algorithm.
- * 
- * @param iterations Number of random pattern iterations
- */
-static void effect_sparkle(int iterations)
-{
-    printf("[Effect] Sparkle\n");
-    
-    /* LFSR seed value */
-    uint8_t pattern = 0x01;
-    
-    for (int i = 0; i < iterations; i++) {
-        /* 
-         * 4-bit LFSR (Linear Feedback Shift Register)
-         * Generates pseudo-random sequence
-         * Taps at positions 0 and 2 (XOR feedback)
-         */
-        uint8_t feedback = ((pattern ^ (pattern >> 2)) & 1);
-        pattern = ((pattern >> 1) | (feedback << 3)) & 0x0F;
-        
-        /* Avoid all-off state */
-        if (pattern == 0) {
-            pattern = 0x05;
-        }
-        
-        /* Apply pattern to LEDs */
-        set_led(0, (pattern & 0x01) != 0);
-        set_led(1, (pattern & 0x02) != 0);
-        set_led(2, (pattern & 0x04) != 0);
-        set_led(3, (pattern & 0x08) != 0);
-        
-        k_msleep(FAST_DELAY_MS);
+    ret = led_show_add_zone(&show, &upper, &zone_playlist, ZONE_SPEED_PCT);
+    if (ret < 0) {
+        LOG_WRN("LED zone needs Breathe and Sparkle (err=%d)", ret);
+        return;
     }
-    all_leds_off();
+    LOG_INF("Zone %d: LEDs %u to %u", ret, (unsigned int)(NUM_LEDS / 2),
+            (unsigned int)(NUM_LEDS - 1));
 }
+#endif /* CONFIG_LED_SHOW_ZONES */
 
-/**
- * @brief Breathe Effect
- * 
- * Simulates a breathing/pulsing effect using software PWM.
- * All LEDs fade in and out together.
- * 
- * Note: This is a software PWM implementation. For smoother
- * results, consider using hardware PWM if available.
- * 
- * @param cycles Number of breath cycles
+/* ============================================================================
+ * BUTTON CONTROL
+ * ============================================================================
+ * sw0: next effect      sw1: previous effect
+ * sw2: cycle speed      sw3: cycle brightness
+ * With CONFIG_LED_SHOW_TAP_BUTTON, sw2 taps the tempo instead.
  */
-static void effect_breathe(int cycles)
-{
-    printf("[Effect] Breathe\n");
-    
-    for (int c = 0; c < cycles; c++) {
-        /* Fade IN: gradually increase ON time */
-        for (int brightness = 0; brightness < 10; brightness++) {
-            for (int pulse = 0; pulse < 5; pulse++) {
-                all_leds_on();
-                k_msleep(brightness);       /* ON time increases */
-                all_leds_off();
-                k_msleep(10 - brightness);  /* OFF time decreases */
-            }
-        }
-        
-        /* Fade OUT: gradually decrease ON time */
-        for (int brightness = 10; brightness > 0; brightness--) {
-            for (int pulse = 0; pulse < 5; pulse++) {
-                all_leds_on();
-                k_msleep(brightness);       /* ON time decreases */
-                all_leds_off();
-                k_msleep(10 - brightness);  /* OFF time increases */
-            }
-        }
-    }
-}
+static const uint16_t speed_steps[] = { 100, 200, 400, 50 };
+static const uint8_t brightness_steps[] = { LED_LEVEL_FULL, 128, 48, 16 };
 
 /**
- * @brief Cascade Effect
+ * @brief Button press handler (interrupt context)
  * 
- * Two adjacent LEDs rotate around all 4 positions.
- * Pattern: [**--] -> [-**-] -> [--**] -> [*--*] -> ...
+ * Effect switches and speed changes are posted to the show's control
+ * channel and preempt the running frame; brightness applies from the
+ * next frame.
  * 
- * @param cycles Number of rotation cycles
+ * @param button Pressed button index (swN)
  */
-static void effect_cascade(int cycles)
+static void on_button(int button)
 {
-    printf("[Effect] Cascade\n");
-    
-    for (int c = 0; c < cycles; c++) {
-        for (int i = 0; i < NUM_LEDS; i++) {
-            all_leds_off();
-            /* Turn on current LED and next LED (with wrap-around) */
-            set_led(i, true);
-            set_led((i + 1) % NUM_LEDS, true);
-            k_msleep(FAST_DELAY_MS);
+    static uint8_t speed_idx;
+    static uint8_t brightness_idx;
+
+    switch (button) {
+    case 0:
+        led_show_control(&show, LED_SHOW_CTL_NEXT);
+        break;
+    case 1:
+        led_show_control(&show, LED_SHOW_CTL_PREV);
+        break;
+    case 2:
+        if (IS_ENABLED(CONFIG_LED_SHOW_TAP_BUTTON)) {
+            led_show_tap(&show);
+            break;
         }
+        speed_idx = (speed_idx + 1) % ARRAY_SIZE(speed_steps);
+        led_show_set_speed(&show, speed_steps[speed_idx]);
+        break;
+    case 3:
+        brightness_idx = (brightness_idx + 1) % ARRAY_SIZE(brightness_steps);
+        led_output_set_brightness(brightness_steps[brightness_idx]);
+        break;
+    default:
+        break;
     }
-    all_leds_off();
 }
 
 /* ============================================================================
@@ -357,7 +243,8 @@ static void effect_cascade(int cycles)
 /**
  * @brief Application entry point
  * 
- * Initializes all 4 LEDs and runs through all effects in a loop.
+ * Initializes the LEDs and starts the show. The show then runs from
+ * a work queue, so main() returns and its thread is released.
  * 
  * @return 0 on success, negative error code on failure
  */
@@ -365,69 +252,58 @@ int main(void)
 {
     int ret;
 
-    printf("\n");
-    printf("========================================\n");
-    printf("    nRF5340 LED Light Show             \n");
-    printf("    Zephyr RTOS Demo                   \n");
-    printf("========================================\n\n");
+    LOG_INF("nRF5340 LED Light Show - Zephyr RTOS Demo");
 
-    /* Initialize all 4 LEDs */
-    for (int i = 0; i < NUM_LEDS; i++) {
+    /* Initialize every LED of the set */
+    for (size_t i = 0; i < NUM_LEDS; i++) {
         /* Check if GPIO port is ready */
         if (!gpio_is_ready_dt(&leds[i])) {
-            printf("[ERROR] LED%d GPIO device not ready\n", i);
+            LOG_ERR("LED%u GPIO device not ready", (unsigned int)i);
             return -1;
         }
 
         /* Configure GPIO pin as output (initially inactive/OFF) */
         ret = gpio_pin_configure_dt(&leds[i], GPIO_OUTPUT_INACTIVE);
         if (ret < 0) {
-            printf("[ERROR] Failed to configure LED%d (err=%d)\n", i, ret);
+            LOG_ERR("Failed to configure LED%u (err=%d)", (unsigned int)i, ret);
             return -1;
         }
-        printf("[OK] LED%d initialized successfully\n", i);
     }
+    LOG_INF("%u LEDs initialized successfully", (unsigned int)NUM_LEDS);
 
-    printf("\n[START] Beginning light show sequence...\n\n");
-
-    /* Main loop: cycle through all effects */
-    while (1) {
-        effect_knight_rider(3);
-        k_msleep(500);
-
-        effect_wave(2);
-        k_msleep(500);
-
-        effect_alternate_flash(6);
-        k_msleep(500);
-
-        effect_converge(4);
-        k_msleep(500);
+    /* Group the LED pins by port for single-write frame commits */
+    ret = (NUM_LEDS > 0) ? led_frame_init(leds, NUM_LEDS) : 0;
+    if (ret < 0) {
+        LOG_ERR("Failed to set up frame commit (err=%d)", ret);
+        return -1;
+    }
 
-        effect_binary_counter(2);
-        k_msleep(500);
+    led_output_init();
 
-        effect_sparkle(50);
-        k_msleep(500);
+    build_playlist();
+    if (default_playlist.num_entries == 0) {
+        LOG_ERR("No effects enabled (CONFIG_LED_SHOW_EFFECT_*)");
+        return -1;
+    }
+    led_show_init(&show, &default_playlist);
+#if defined(CONFIG_LED_SHOW_ZONES)
+    if (NUM_LEDS >= 2) {
+        add_zone();
+    }
+#endif
+    show_shell_init(&show);
 
-        effect_breathe(2);
-        k_msleep(500);
+    ret = buttons_init(on_button);
+    if (ret < 0) {
+        LOG_ERR("Failed to set up buttons (err=%d)", ret);
+        return -1;
+    }
+    LOG_INF("%d control button(s) enabled", ret);
 
-        effect_cascade(8);
-        k_msleep(500);
+    LOG_INF("[START] Beginning light show sequence...");
 
-        /* Grand Finale: rapid flashing */
-        printf("[Effect] Grand Finale\n");
-        for (int i = 0; i < 10; i++) {
-            all_leds_on();
-            k_msleep(50);
-            all_leds_off();
-            k_msleep(50);
-        }
-        
-        printf("\n[LOOP] Restarting sequence...\n\n");
-        k_msleep(1000);
-    }
+    /* Cycle through all effects, one frame per work item run */
+    led_show_start(&show);
 
     return 0;
 }
@@ -0,0 +1,421 @@
+/*
+ * LED Show Shell Commands
+ *
+ * Description: "show" shell command tree.
+ *                show stats        frame timing per effect and histogram
+ *                show stats reset  clear the timing figures
+ *                show trace        frame trace as CSV lines
+ *                show trace clear  discard the trace
+ *                show effects      effects built into the image
+ *                show playlist     current playlist
+ *                show playlist set <effect>[:cycles[:gap_ms[:tempo_pct
+ *                                  [:fade_ms]]]] ...
+ *                                  replace the playlist, e.g.
+ *                                  "show playlist set sparkle:20 0:3:250"
+ *                show tempo [bpm]  show or set the tempo, e.g. "128.5"
+ *                show tempo tap    tap the tempo, send repeatedly
+ *
+ * License:     MIT
+ */
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+
+#include "effects.h"
+#include "frame_stats.h"
+#include "frame_trace.h"
+#include "led_tempo.h"
+#include "show_shell.h"
+
+/* Entries of a playlist given on the command line */
+#define SHELL_PLAYLIST_MAX 16
+
+/* Defaults of the optional fields of "show playlist set" */
+#define SHELL_GAP_MS 500
+
+static struct led_show *shell_show;
+
+/*
+ * Playlists set from the shell, used alternately: the one being filled is
+ * never the one the show is playing.
+ */
+static struct led_playlist_entry shell_entries[2][SHELL_PLAYLIST_MAX];
+static struct led_playlist shell_playlists[2] = {
+    { .entries = shell_entries[0] },
+    { .entries = shell_entries[1] },
+};
+
+void show_shell_init(struct led_show *show)
+{
+    shell_show = show;
+}
+
+/**
+ * @brief Print one summary line
+ */
+static void print_summary(const struct shell *sh, const char *name,
+                          const struct frame_stats_summary *s)
+{
+    shell_print(sh, "%-16s %8u %7u %7u %7u %7u", name, s->frames, s->missed,
+                s->min_us, s->p99_us, s->max_us);
+}
+
+static int cmd_stats(const struct shell *sh, size_t argc, char **argv)
+{
+    struct frame_stats_summary s;
+
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    shell_print(sh, "%-16s %8s %7s %7s %7s %7s", "effect", "frames",
+                "missed", "min_us", "p99_us", "max_us");
+
+    for (int i = 0; i < frame_stats_num_sources(); i++) {
+        const char *name = frame_stats_name(i);
+
+        if (name == NULL) {
+            continue;
+        }
+        frame_stats_get(i, &s);
+        print_summary(sh, name, &s);
+    }
+
+    frame_stats_get(FRAME_STATS_ALL, &s);
+    print_summary(sh, "(all)", &s);
+
+    shell_print(sh, "\nlateness histogram (all frames):");
+    for (int b = 0; b < FRAME_STATS_BUCKETS; b++) {
+        if (s.hist[b] == 0) {
+            continue;
+        }
+        if (b == FRAME_STATS_BUCKETS - 1) {
+            shell_print(sh, "  >= %5u us %8u",
+                        frame_stats_bucket_max_us(b - 1) + 1, s.hist[b]);
+        } else {
+            shell_print(sh, "  <= %5u us %8u",
+                        frame_stats_bucket_max_us(b), s.hist[b]);
+        }
+    }
+
+    return 0;
+}
+
+static int cmd_stats_reset(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    frame_stats_reset();
+    shell_print(sh, "Frame timing statistics cleared");
+
+    return 0;
+}
+
+static int cmd_trace(const struct shell *sh, size_t argc, char **argv)
+{
+    struct frame_trace_entry e;
+
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    shell_print(sh, "TRACE,t_us,word,toggled,level");
+    for (uint32_t i = 0; frame_trace_get(i, &e) == 0; i++) {
+        shell_print(sh, "TRACE,%u,%u,0x%08x,%u", e.t_us, e.word, e.toggled,
+                    e.level);
+    }
+    shell_print(sh, "TRACE,end,%u,%u", frame_trace_count(),
+                frame_trace_dropped());
+
+    return 0;
+}
+
+static int cmd_trace_clear(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    frame_trace_clear();
+    shell_print(sh, "Frame trace cleared");
+
+    return 0;
+}
+
+static int cmd_effects(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    shell_print(sh, "%3s %-16s %6s", "id", "effect", "cycles");
+    for (unsigned int id = 0; id < LED_EFFECT_ID_COUNT; id++) {
+        const struct led_effect *effect = led_effect_get(id);
+
+        if (effect != NULL) {
+            shell_print(sh, "%3u %-16s %6u", id, effect->name, effect->cycles);
+        }
+    }
+
+    return 0;
+}
+
+static int cmd_playlist(const struct shell *sh, size_t argc, char **argv)
+{
+    const struct led_playlist *playlist;
+
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    if (shell_show == NULL) {
+        shell_error(sh, "Show not running");
+        return -ENODEV;
+    }
+
+    playlist = led_show_get_playlist(shell_show);
+    shell_print(sh, "%3s %-16s %6s %6s %6s %7s", "#", "effect", "cycles",
+                "gap_ms", "tempo", "fade_ms");
+    for (uint16_t i = 0; i < playlist->num_entries; i++) {
+        const struct led_playlist_entry *entry = &playlist->entries[i];
+
+        shell_print(sh, "%3u %-16s %6u %6u %5u%% %7u", i,
+                    led_effect_get(entry->effect)->name, entry->cycles,
+                    entry->gap_ms, entry->tempo_pct, entry->fade_ms);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Whether @p arg names @p name, ignoring case, '_' matching ' '
+ */
+static bool effect_name_matches(const char *arg, const char *name)
+{
+    for (; *arg != '\0' && *arg != ':'; arg++, name++) {
+        char c = (*arg == '_') ? ' ' : *arg;
+
+        if (tolower((unsigned char)c) != tolower((unsigned char)*name)) {
+            return false;
+        }
+    }
+
+    return *name == '\0';
+}
+
+/**
+ * @brief Resolve an effect given by id or by name
+ *
+ * @return Effect id, or -1 if no such effect is built in
+ */
+static int parse_effect(const char *arg)
+{
+    if (isdigit((unsigned char)arg[0])) {
+        unsigned long id = strtoul(arg, NULL, 10);
+
+        return led_effect_get(id) ? (int)id : -1;
+    }
+
+    for (unsigned int id = 0; id < LED_EFFECT_ID_COUNT; id++) {
+        const struct led_effect *effect = led_effect_get(id);
+
+        if (effect != NULL && effect_name_matches(arg, effect->name)) {
+            return (int)id;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Parse "<effect>[:cycles[:gap_ms[:tempo_pct[:fade_ms]]]]"
+ *
+ * Fields left out take the effect's default cycle count, SHELL_GAP_MS,
+ * the nominal tempo and no cross-fade.
+ */
+static int parse_entry(const char *arg, struct led_playlist_entry *entry)
+{
+    unsigned long fields[4];
+    const char *p = strchr(arg, ':');
+    int id = parse_effect(arg);
+
+    if (id < 0) {
+        return -ENOENT;
+    }
+
+    fields[0] = led_effect_get(id)->cycles;
+    fields[1] = SHELL_GAP_MS;
+    fields[2] = LED_SHOW_SPEED_NOMINAL;
+    fields[3] = 0;
+
+    for (size_t f = 0; p != NULL && f < ARRAY_SIZE(fields); f++) {
+        char *end;
+
+        fields[f] = strtoul(p + 1, &end, 10);
+        if (end == p + 1 || (*end != ':' && *end != '\0') ||
+            fields[f] > UINT16_MAX) {
+            return -EINVAL;
+        }
+        p = (*end == ':') ? end : NULL;
+    }
+
+    *entry = (struct led_playlist_entry){
+        .effect = (uint8_t)id,
+        .cycles = (uint16_t)fields[0],
+        .gap_ms = (uint16_t)fields[1],
+        .tempo_pct = (uint16_t)fields[2],
+        .fade_ms = (uint16_t)fields[3],
+    };
+
+    return 0;
+}
+
+static int cmd_playlist_set(const struct shell *sh, size_t argc, char **argv)
+{
+    struct led_playlist *playlist;
+    int buf;
+    int ret;
+
+    if (shell_show == NULL) {
+        shell_error(sh, "Show not running");
+        return -ENODEV;
+    }
+    if (argc - 1 > SHELL_PLAYLIST_MAX) {
+        shell_error(sh, "At most %d entries", SHELL_PLAYLIST_MAX);
+        return -EINVAL;
+    }
+
+    /* Fill the buffer the show is not playing */
+    buf = (led_show_get_playlist(shell_show) == &shell_playlists[0]) ? 1 : 0;
+    playlist = &shell_playlists[buf];
+
+    for (size_t i = 1; i < argc; i++) {
+        ret = parse_entry(argv[i], &shell_entries[buf][i - 1]);
+        if (ret < 0) {
+            shell_error(sh, "%s: %s", argv[i],
+                        (ret == -ENOENT) ? "unknown effect" : "bad number");
+            return ret;
+        }
+    }
+    playlist->num_entries = (uint16_t)(argc - 1);
+
+    /* The overlay layers stay as they are */
+    playlist->layers = led_show_get_playlist(shell_show)->layers;
+    playlist->num_layers = led_show_get_playlist(shell_show)->num_layers;
+
+    ret = led_show_set_playlist(shell_show, playlist, K_SECONDS(1));
+    if (ret < 0) {
+        shell_error(sh, "Playlist not taken (err=%d)", ret);
+        return ret;
+    }
+    shell_print(sh, "Playing %u entries", playlist->num_entries);
+
+    return 0;
+}
+
+/**
+ * @brief Parse a BPM with up to two decimals into hundredths of a BPM
+ *
+ * @return Tempo, or 0 if @p arg is not a number or above LED_TEMPO_MAX
+ */
+static uint32_t parse_bpm(const char *arg)
+{
+    char *end;
+    unsigned long whole = strtoul(arg, &end, 10);
+    uint32_t bpm;
+
+    /* Checked before scaling, so huge values cannot wrap into range */
+    if (end == arg || whole > LED_TEMPO_MAX / 100U) {
+        return 0;
+    }
+    bpm = (uint32_t)whole * 100U;
+    if (*end == '.') {
+        for (uint32_t scale = 10; isdigit((unsigned char)*++end); scale /= 10) {
+            bpm += (uint32_t)(*end - '0') * scale;
+        }
+    }
+
+    return (*end == '\0') ? bpm : 0;
+}
+
+static int cmd_tempo(const struct shell *sh, size_t argc, char **argv)
+{
+    uint32_t bpm;
+
+    if (argc > 1) {
+        if (shell_show == NULL) {
+            shell_error(sh, "Show not running");
+            return -ENODEV;
+        }
+        bpm = parse_bpm(argv[1]);
+        if (led_show_set_bpm(shell_show, bpm) < 0) {
+            shell_error(sh, "%s: tempo must be %u to %u BPM", argv[1],
+                        LED_TEMPO_MIN / 100U, LED_TEMPO_MAX / 100U);
+            return -EINVAL;
+        }
+    }
+
+    bpm = led_tempo_get_bpm();
+    shell_print(sh, "%u.%02u BPM", bpm / 100U, bpm % 100U);
+
+    return 0;
+}
+
+static int cmd_tempo_tap(const struct shell *sh, size_t argc, char **argv)
+{
+    int ret;
+
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    if (shell_show == NULL) {
+        shell_error(sh, "Show not running");
+        return -ENODEV;
+    }
+
+    ret = led_show_tap(shell_show);
+    if (ret == 0) {
+        shell_print(sh, "Tap again");
+    } else if (ret < 0) {
+        shell_error(sh, "Taps out of tempo range");
+    } else {
+        shell_print(sh, "%u.%02u BPM", (unsigned int)ret / 100U,
+                    (unsigned int)ret % 100U);
+    }
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_stats,
+    SHELL_CMD(reset, NULL, "Clear the timing figures", cmd_stats_reset),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_trace,
+    SHELL_CMD(clear, NULL, "Discard the trace", cmd_trace_clear),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_playlist,
+    SHELL_CMD_ARG(set, NULL,
+                  "Replace the playlist: "
+                  "<effect>[:cycles[:gap_ms[:tempo_pct[:fade_ms]]]] ...",
+                  cmd_playlist_set, 2, SHELL_PLAYLIST_MAX - 1),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_tempo,
+    SHELL_CMD(tap, NULL, "Tap the tempo", cmd_tempo_tap),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_show,
+    SHELL_CMD(stats, &sub_stats, "Frame timing per effect", cmd_stats),
+    SHELL_CMD(trace, &sub_trace, "Frame trace as CSV", cmd_trace),
+    SHELL_CMD(effects, NULL, "Effects built into the image", cmd_effects),
+    SHELL_CMD(playlist, &sub_playlist, "Current playlist", cmd_playlist),
+    SHELL_CMD_ARG(tempo, &sub_tempo, "Show or set the tempo: [bpm]",
+                  cmd_tempo, 1, 1),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(show, &sub_show, "LED light show commands", NULL);
@@ -0,0 +1,27 @@
+/*
+ * LED Show Shell Commands
+ *
+ * Description: Connects the "show" shell command tree to the running
+ *              show, for the commands that control it.
+ *
+ * License:     MIT
+ */
+
+#ifndef SHOW_SHELL_H_
+#define SHOW_SHELL_H_
+
+#include "led_show.h"
+
+#if defined(CONFIG_LED_SHOW_SHELL)
+/**
+ * @brief Give the shell commands the show to control
+ */
+void show_shell_init(struct led_show *show);
+#else
+static inline void show_shell_init(struct led_show *show)
+{
+    ARG_UNUSED(show);
+}
+#endif
+
+#endif /* SHOW_SHELL_H_ */
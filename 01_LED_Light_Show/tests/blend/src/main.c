@@ -0,0 +1,164 @@
+/*
+ * Blend Kernel Test
+ *
+ * Description: Checks led_blend() for every mode at several opacities,
+ *              and led_blend_scale(), against a plain per-LED reference.
+ *              Every pair of levels is covered: the layer counts 0 to 255
+ *              along the buffer and the levels under it start one step
+ *              further on each run, so neighbouring lanes always differ.
+ *
+ *              On native_sim this checks the SWAR kernels, on mps2_an521
+ *              (Cortex-M33) the DSP ones.
+ *
+ * License:     MIT
+ */
+
+#include <zephyr/ztest.h>
+
+#include "led_blend.h"
+
+/* One lane per layer level */
+#define TEST_LEDS   256
+#define TEST_WORDS  (TEST_LEDS / LED_BLEND_LANES)
+
+static const uint8_t opacities[] = {
+    0, 1, 64, 127, 128, 200, 254, LED_BLEND_OPAQUE,
+};
+
+static uint32_t dst[TEST_WORDS];
+static uint32_t src[TEST_WORDS];
+
+static uint8_t lane_get(const uint32_t *words, size_t led)
+{
+    return (uint8_t)(words[led / LED_BLEND_LANES] >>
+                     (8 * (led % LED_BLEND_LANES)));
+}
+
+static void lane_set(uint32_t *words, size_t led, uint8_t level)
+{
+    uint32_t shift = 8 * (led % LED_BLEND_LANES);
+    uint32_t *word = &words[led / LED_BLEND_LANES];
+
+    *word = (*word & ~(0xFFU << shift)) | ((uint32_t)level << shift);
+}
+
+/* ============================================================================
+ * REFERENCE
+ * ============================================================================
+ */
+
+/**
+ * @brief Blend of one LED at full opacity
+ */
+static uint8_t ref_blend(enum led_blend_mode mode, uint8_t d, uint8_t s)
+{
+    switch (mode) {
+    case LED_BLEND_ADD:
+        return (uint8_t)MIN((uint32_t)d + s, 255U);
+    case LED_BLEND_MAX:
+        return MAX(d, s);
+    case LED_BLEND_MULTIPLY:
+        /* d * s / 255, rounded; 255 is odd, so there are no ties */
+        return (uint8_t)(((uint32_t)d * s + 127) / 255);
+    case LED_BLEND_ALPHA:
+        return (s != 0) ? s : d;
+    default:
+        return d;
+    }
+}
+
+/**
+ * @brief @p d mixed towards @p r by @p opacity (0 to 255 as 0 to 256/256)
+ */
+static uint8_t ref_mix(uint8_t d, uint8_t r, uint8_t opacity)
+{
+    uint32_t mix = opacity + (opacity >> 7);
+
+    return (uint8_t)(((uint32_t)d * (256 - mix) + (uint32_t)r * mix) >> 8);
+}
+
+/* ============================================================================
+ * TESTS
+ * ============================================================================
+ */
+
+/**
+ * @brief Blend every pair of levels in @p mode at every test opacity
+ */
+static void check_mode(enum led_blend_mode mode)
+{
+    for (size_t o = 0; o < ARRAY_SIZE(opacities); o++) {
+        uint8_t opacity = opacities[o];
+
+        for (uint32_t start = 0; start < 256; start++) {
+            for (size_t i = 0; i < TEST_LEDS; i++) {
+                lane_set(dst, i, (uint8_t)(start + i));
+                lane_set(src, i, (uint8_t)i);
+            }
+
+            led_blend(mode, dst, src, TEST_WORDS, opacity);
+
+            for (size_t i = 0; i < TEST_LEDS; i++) {
+                uint8_t d = (uint8_t)(start + i);
+                uint8_t s = (uint8_t)i;
+                uint8_t want = ref_mix(d, ref_blend(mode, d, s), opacity);
+
+                zassert_equal(lane_get(dst, i), want,
+                              "mode %d opacity %u: %u over %u = %u, "
+                              "expected %u", mode, opacity, s, d,
+                              lane_get(dst, i), want);
+            }
+        }
+    }
+}
+
+ZTEST(led_blend, test_add)
+{
+    check_mode(LED_BLEND_ADD);
+}
+
+ZTEST(led_blend, test_max)
+{
+    check_mode(LED_BLEND_MAX);
+}
+
+ZTEST(led_blend, test_multiply)
+{
+    check_mode(LED_BLEND_MULTIPLY);
+}
+
+ZTEST(led_blend, test_alpha)
+{
+    check_mode(LED_BLEND_ALPHA);
+}
+
+ZTEST(led_blend, test_scale)
+{
+    for (size_t o = 0; o < ARRAY_SIZE(opacities); o++) {
+        uint8_t level = opacities[o];
+
+        for (size_t i = 0; i < TEST_LEDS; i++) {
+            lane_set(dst, i, (uint8_t)i);
+        }
+
+        led_blend_scale(dst, TEST_WORDS, level);
+
+        for (size_t i = 0; i < TEST_LEDS; i++) {
+            uint8_t want = ref_mix(0, (uint8_t)i, level);
+
+            zassert_equal(lane_get(dst, i), want,
+                          "level %u: %u scaled to %u, expected %u", level,
+                          (unsigned int)i, lane_get(dst, i), want);
+        }
+    }
+}
+
+static void *blend_setup(void)
+{
+    TC_PRINT("Kernels: %s\n",
+             IS_ENABLED(CONFIG_LED_SHOW_BLEND_DSP) ? "DSP" : "SWAR");
+
+    return NULL;
+}
+
+ZTEST_SUITE(led_blend, NULL, blend_setup, NULL, NULL, NULL);
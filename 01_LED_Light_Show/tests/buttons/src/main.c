@@ -0,0 +1,193 @@
+/*
+ * Button Switch Test
+ *
+ * Description: Runs a two-effect show on the emulated GPIO controller of
+ *              native_sim, presses sw0 and sw1 with gpio_emul_input_set()
+ *              in the middle of an effect frame and checks that the LEDs
+ *              show the new effect within one frame of the edge, instead
+ *              of once the running frame is over.
+ *
+ * License:     MIT
+ */
+
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/ztest.h>
+
+#include "buttons.h"
+#include "effects.h"
+#include "frame_queue.h"
+#include "led_frame.h"
+#include "led_output.h"
+#include "led_show.h"
+#include "led_tempo.h"
+
+#define LED_SPEC(node_id) GPIO_DT_SPEC_GET(node_id, gpios),
+
+static const struct gpio_dt_spec leds[] = {
+    DT_FOREACH_CHILD_STATUS_OKAY(DT_CHOSEN(led_show_leds), LED_SPEC)
+};
+
+static const struct gpio_dt_spec sw_next = GPIO_DT_SPEC_GET(DT_ALIAS(sw0),
+                                                            gpios);
+static const struct gpio_dt_spec sw_prev = GPIO_DT_SPEC_GET(DT_ALIAS(sw1),
+                                                            gpios);
+
+/* Frame lengths at the reference tempo, see effects/effect_defs.h */
+#define FLASH_FRAME_MS      LED_TEMPO_BEATS_MS(1, 2) /* Alternate Flash */
+#define COUNTER_FRAME_MS    LED_TEMPO_BEATS_MS(1, 4) /* Binary Counter */
+
+/* One frame: the shortest frame of the two effects */
+#define SWITCH_MAX_US       (COUNTER_FRAME_MS * 1000U)
+
+/* Time given to the output after an edge, well below one frame */
+#define SWITCH_WAIT_MS      2
+
+/* Longer than the debounce time of buttons.c */
+#define DEBOUNCE_WAIT_MS    60
+
+/* First frame of each effect on the 4 LEDs (LEDS_EVEN, counter 0) */
+#define FLASH_FIRST_PINS    (BIT(0) | BIT(2))
+#define COUNTER_FIRST_PINS  0
+
+static const struct led_playlist_entry entries[] = {
+    { .effect = LED_EFFECT_ALTERNATE_FLASH, .cycles = 100,
+      .tempo_pct = LED_SHOW_SPEED_NOMINAL },
+    { .effect = LED_EFFECT_BINARY_COUNTER, .cycles = 100,
+      .tempo_pct = LED_SHOW_SPEED_NOMINAL },
+};
+
+static const struct led_playlist playlist = {
+    .entries = entries,
+    .num_entries = ARRAY_SIZE(entries),
+};
+
+static struct led_show show;
+static int init_ret;
+
+static void on_button(int button)
+{
+    led_show_control(&show, (button == 0) ? LED_SHOW_CTL_NEXT
+                                          : LED_SHOW_CTL_PREV);
+}
+
+/**
+ * @brief Output state of the LED pins, bit N = LED N
+ */
+static uint32_t led_pins(void)
+{
+    uint32_t pins = 0;
+
+    for (size_t i = 0; i < ARRAY_SIZE(leds); i++) {
+        if (gpio_emul_output_get(leds[i].port, leds[i].pin) > 0) {
+            pins |= BIT(i);
+        }
+    }
+
+    return pins;
+}
+
+/**
+ * @brief Press and release a button (active low)
+ */
+static void press(const struct gpio_dt_spec *button)
+{
+    gpio_emul_input_set(button->port, button->pin, 0);
+    gpio_emul_input_set(button->port, button->pin, 1);
+}
+
+static void *buttons_setup(void)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(leds); i++) {
+        init_ret = gpio_pin_configure_dt(&leds[i], GPIO_OUTPUT_INACTIVE);
+        if (init_ret < 0) {
+            return NULL;
+        }
+    }
+
+    init_ret = led_frame_init(leds, ARRAY_SIZE(leds));
+    if (init_ret < 0) {
+        return NULL;
+    }
+    led_output_init();
+
+    led_show_init(&show, &playlist);
+    init_ret = buttons_init(on_button);
+    if (init_ret < 0) {
+        return NULL;
+    }
+
+    /* Buttons released: inputs high */
+    gpio_emul_input_set(sw_next.port, sw_next.pin, 1);
+    gpio_emul_input_set(sw_prev.port, sw_prev.pin, 1);
+
+    return NULL;
+}
+
+static void buttons_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    zassert_true(init_ret >= 2, "buttons not set up (%d)", init_ret);
+    zassert_false(led_output_has_dimming(), "LEDs must be on GPIO");
+
+    led_show_start(&show);
+}
+
+static void buttons_after(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    zassert_ok(led_show_stop(&show, K_MSEC(100)));
+}
+
+/**
+ * @brief Press @p button mid-frame and check the switch to @p item
+ */
+static void check_switch(const struct gpio_dt_spec *button, uint16_t item,
+                         uint32_t first_pins)
+{
+    struct frame_queue_stats stats;
+
+    press(button);
+    k_sleep(K_MSEC(SWITCH_WAIT_MS));
+
+    zassert_equal(show.zones[0].item, item, "item %u, expected %u",
+                  show.zones[0].item, item);
+    zassert_equal(led_pins(), first_pins, "LEDs 0x%x, expected 0x%x",
+                  led_pins(), first_pins);
+
+    frame_queue_get_stats(&stats);
+    zassert_true(stats.switch_last_us < SWITCH_MAX_US,
+                 "switch took %u us", stats.switch_last_us);
+}
+
+ZTEST(buttons, test_switch_within_one_frame)
+{
+    /* Halfway through the first Alternate Flash frame */
+    k_sleep(K_MSEC(FLASH_FRAME_MS / 2));
+    zassert_equal(led_pins(), FLASH_FIRST_PINS);
+
+    /* Next: Binary Counter, long before the flash frame is over */
+    check_switch(&sw_next, 1, COUNTER_FIRST_PINS);
+
+    /* Previous: back to Alternate Flash, inside the first counter frame */
+    k_sleep(K_MSEC(DEBOUNCE_WAIT_MS));
+    check_switch(&sw_prev, 0, FLASH_FIRST_PINS);
+}
+
+ZTEST(buttons, test_bounce_is_one_press)
+{
+    k_sleep(K_MSEC(DEBOUNCE_WAIT_MS));
+
+    /* A bouncing contact: three edges within the debounce time */
+    press(&sw_next);
+    press(&sw_next);
+    press(&sw_next);
+    k_sleep(K_MSEC(SWITCH_WAIT_MS));
+
+    zassert_equal(show.zones[0].item, 1, "bounce counted as presses");
+}
+
+ZTEST_SUITE(buttons, NULL, buttons_setup, buttons_before, buttons_after,
+            NULL);
@@ -0,0 +1,149 @@
+/*
+ * PWM Backend Test
+ *
+ * Description: Plays one cycle of Breathe into led_pwm_set() and checks
+ *              every pulse width the fake PWM controller of native_sim
+ *              (zephyr,fake-pwm, 16 MHz) is given: the level ramp up and
+ *              down, mapped through the quadratic brightness curve.
+ *
+ * License:     MIT
+ */
+
+#include <zephyr/drivers/pwm.h>
+#include <zephyr/drivers/pwm/pwm_fake.h>
+#include <zephyr/ztest.h>
+
+#include "effects.h"
+#include "led_pwm.h"
+
+/* Fake PWM clock, "frequency" of fake_pwm in boards/native_sim.overlay */
+#define FAKE_PWM_HZ         16000000ULL
+
+/* PWM LEDs in boards/native_sim.overlay */
+#define PWM_LEDS            4
+
+/* Breathe: 51 steps up (0 to full), 51 down, see effects/breathe.c */
+#define BREATHE_STEPS       50
+#define BREATHE_FRAMES      (2 * (BREATHE_STEPS + 1))
+
+#define PERIOD_NS           (CONFIG_LED_SHOW_PWM_PERIOD_US * 1000ULL)
+#define NS_TO_CYCLES(_ns)   ((uint32_t)((_ns) * FAKE_PWM_HZ / 1000000000ULL))
+
+/* Last cycles set on every channel */
+static uint32_t period_cycles[PWM_LEDS];
+static uint32_t pulse_cycles[PWM_LEDS];
+
+static int record_cycles(const struct device *dev, uint32_t channel,
+                         uint32_t period, uint32_t pulse, pwm_flags_t flags)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(flags);
+
+    if (channel < PWM_LEDS) {
+        period_cycles[channel] = period;
+        pulse_cycles[channel] = pulse;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Pulse width expected for a level: period * (level / 255)^2
+ */
+static uint32_t expected_pulse(uint8_t level)
+{
+    uint64_t ns = PERIOD_NS * level * level /
+                  (LED_PWM_LEVEL_MAX * LED_PWM_LEVEL_MAX);
+
+    return NS_TO_CYCLES(ns);
+}
+
+/* Result of led_pwm_init(), checked before every test */
+static int init_ret;
+
+static void *pwm_setup(void)
+{
+    init_ret = led_pwm_init();
+
+    return NULL;
+}
+
+static void pwm_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    zassert_ok(init_ret, "PWM LEDs not ready");
+    zassert_true(led_pwm_available());
+
+    RESET_FAKE(fake_pwm_set_cycles);
+    fake_pwm_set_cycles_fake.custom_fake = record_cycles;
+}
+
+ZTEST(led_pwm, test_breathe_ramp)
+{
+    const struct led_effect *breathe = led_effect_get(LED_EFFECT_BREATHE);
+    struct effect_state state = { 0 };
+    struct led_frame frame;
+    struct led_step step = { .frame = &frame };
+    uint32_t last_pulse = 0;
+    bool cycle_end = false;
+
+    zassert_not_null(breathe, "Breathe not built in");
+
+    for (int i = 0; i < BREATHE_FRAMES; i++) {
+        int ramp = (i <= BREATHE_STEPS) ? i : (2 * BREATHE_STEPS + 1 - i);
+        uint8_t level = (uint8_t)(ramp * LED_PWM_LEVEL_MAX / BREATHE_STEPS);
+
+        zassert_false(cycle_end, "cycle ended early at frame %d", i);
+        cycle_end = breathe->step(breathe, &state, &step);
+        zassert_equal(step.level, level, "frame %d: level %u, expected %u",
+                      i, step.level, level);
+
+        zassert_ok(led_pwm_set(&frame, step.level));
+
+        for (int led = 0; led < PWM_LEDS; led++) {
+            zassert_equal(period_cycles[led], NS_TO_CYCLES(PERIOD_NS),
+                          "frame %d LED %d: period %u", i, led,
+                          period_cycles[led]);
+            zassert_equal(pulse_cycles[led], expected_pulse(level),
+                          "frame %d LED %d: pulse %u, expected %u", i, led,
+                          pulse_cycles[led], expected_pulse(level));
+        }
+
+        /* Widths rise to the full period, then fall back to 0 */
+        if (i <= BREATHE_STEPS) {
+            zassert_true(pulse_cycles[0] >= last_pulse, "frame %d", i);
+        } else {
+            zassert_true(pulse_cycles[0] <= last_pulse, "frame %d", i);
+        }
+        last_pulse = pulse_cycles[0];
+    }
+
+    zassert_true(cycle_end, "Breathe cycle longer than %d frames",
+                 BREATHE_FRAMES);
+    zassert_equal(expected_pulse(LED_PWM_LEVEL_MAX), NS_TO_CYCLES(PERIOD_NS));
+    zassert_equal(last_pulse, 0);
+    zassert_equal(fake_pwm_set_cycles_fake.call_count,
+                  BREATHE_FRAMES * PWM_LEDS);
+}
+
+ZTEST(led_pwm, test_unlit_leds_off)
+{
+    struct led_frame frame = { 0 };
+
+    /* LEDs 0 and 2 at half level, the others off */
+    frame.words[0] = BIT(0) | BIT(2);
+    zassert_ok(led_pwm_set(&frame, 128));
+
+    zassert_equal(pulse_cycles[0], expected_pulse(128));
+    zassert_equal(pulse_cycles[1], 0);
+    zassert_equal(pulse_cycles[2], expected_pulse(128));
+    zassert_equal(pulse_cycles[3], 0);
+
+    zassert_ok(led_pwm_set(NULL, LED_PWM_LEVEL_MAX));
+    for (int led = 0; led < PWM_LEDS; led++) {
+        zassert_equal(pulse_cycles[led], 0, "LED %d still on", led);
+    }
+}
+
+ZTEST_SUITE(led_pwm, NULL, pwm_setup, pwm_before, NULL, NULL);
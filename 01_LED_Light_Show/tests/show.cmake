@@ -0,0 +1,30 @@
+# SPDX-License-Identifier: MIT
+#
+# Light show sources for the test applications: everything the show runs
+# on except main.c and the shell. Include after find_package(Zephyr).
+
+set(SHOW_SRC ${CMAKE_CURRENT_LIST_DIR}/../src)
+
+target_include_directories(app PRIVATE ${SHOW_SRC})
+
+target_sources(app PRIVATE
+    ${SHOW_SRC}/effects.c
+    ${SHOW_SRC}/led_frame.c
+    ${SHOW_SRC}/led_pattern.c
+    ${SHOW_SRC}/led_vm.c
+    ${SHOW_SRC}/frame_sched.c
+    ${SHOW_SRC}/led_tempo.c
+    ${SHOW_SRC}/led_pwm.c
+    ${SHOW_SRC}/led_bam.c
+    ${SHOW_SRC}/led_blend.c
+    ${SHOW_SRC}/led_layer.c
+    ${SHOW_SRC}/led_output.c
+    ${SHOW_SRC}/led_strip_out.c
+    ${SHOW_SRC}/led_show.c
+    ${SHOW_SRC}/frame_queue.c
+    ${SHOW_SRC}/frame_stats.c
+    ${SHOW_SRC}/frame_trace.c
+    ${SHOW_SRC}/frame_vcd.c
+)
+
+add_subdirectory(${SHOW_SRC}/effects effects)
@@ -0,0 +1,185 @@
+/*
+ * LED Strip Backend Test
+ *
+ * Description: Shows frames, blended frames and per-LED levels through
+ *              led_strip_out.c on a 40-pixel mock strip and checks every
+ *              pixel of the buffers the strip thread transferred against
+ *              CONFIG_LED_SHOW_STRIP_COLOR at the expected level.
+ *
+ * License:     MIT
+ */
+
+#include <string.h>
+#include <zephyr/ztest.h>
+
+#include "led_frame.h"
+#include "led_output.h"
+#include "led_strip_out.h"
+#include "strip_mock.h"
+
+/* Longest wait for the strip thread to pick a frame up */
+#define XFER_TIMEOUT    K_MSEC(100)
+
+/**
+ * @brief One channel of the strip color at a level, gamma 2
+ */
+static uint8_t channel(int shift, uint8_t level)
+{
+    uint32_t full = (CONFIG_LED_SHOW_STRIP_COLOR >> shift) & 0xFF;
+    uint32_t duty = ((uint32_t)level * level + 254) / 255;
+
+    return (uint8_t)(full * duty / 255);
+}
+
+/**
+ * @brief Check one transferred pixel
+ */
+static void check_pixel(const struct led_rgb *px, size_t i, uint8_t level)
+{
+    zassert_equal(px[i].r, channel(16, level), "pixel %u red %u, level %u",
+                  (unsigned int)i, px[i].r, level);
+    zassert_equal(px[i].g, channel(8, level), "pixel %u green %u, level %u",
+                  (unsigned int)i, px[i].g, level);
+    zassert_equal(px[i].b, channel(0, level), "pixel %u blue %u, level %u",
+                  (unsigned int)i, px[i].b, level);
+}
+
+/**
+ * @brief Wait for a transfer and check all pixels against @p levels
+ */
+static void check_transfer(const uint8_t *levels)
+{
+    const struct led_rgb *px;
+    size_t len;
+
+    zassert_ok(strip_mock_wait(XFER_TIMEOUT), "no transfer");
+    px = strip_mock_last(&len);
+    zassert_equal(len, STRIP_MOCK_LEN, "%u pixels sent", (unsigned int)len);
+
+    for (size_t i = 0; i < STRIP_MOCK_LEN; i++) {
+        check_pixel(px, i, levels[i]);
+    }
+}
+
+static void set_led(struct led_frame *frame, size_t led)
+{
+    frame->words[led / LED_FRAME_WORD_BITS] |=
+        (led_mask_t)BIT(led % LED_FRAME_WORD_BITS);
+}
+
+static int init_ret;
+
+static void *strip_setup(void)
+{
+    init_ret = led_strip_out_init();
+
+    return NULL;
+}
+
+static void strip_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    zassert_ok(init_ret, "strip not ready");
+    zassert_true(led_strip_out_available());
+
+    /* Let the blanking frame of init (or the previous test) go out */
+    k_sleep(K_MSEC(10));
+    strip_mock_reset();
+}
+
+ZTEST(led_strip_out, test_frame)
+{
+    static const size_t lit[] = { 0, 3, 31, 32, 39 };
+    struct led_frame frame = { 0 };
+    uint8_t levels[STRIP_MOCK_LEN] = { 0 };
+
+    for (size_t i = 0; i < ARRAY_SIZE(lit); i++) {
+        set_led(&frame, lit[i]);
+        levels[lit[i]] = 200;
+    }
+
+    led_strip_out_show(&frame, 200);
+    check_transfer(levels);
+
+    /* All off: words without a lit LED are cleared, not left stale */
+    led_frame_clear(&frame);
+    memset(levels, 0, sizeof(levels));
+    led_strip_out_show(&frame, 200);
+    check_transfer(levels);
+}
+
+ZTEST(led_strip_out, test_blend)
+{
+    struct led_frame a = { 0 };
+    struct led_frame b = { 0 };
+    uint8_t levels[STRIP_MOCK_LEN] = { 0 };
+
+    /* 0 and 33 only in a, 2 and 34 only in b, 1 in both */
+    set_led(&a, 0);
+    set_led(&a, 1);
+    set_led(&a, 33);
+    set_led(&b, 1);
+    set_led(&b, 2);
+    set_led(&b, 34);
+
+    levels[0] = 200;
+    levels[33] = 200;
+    levels[2] = 90;
+    levels[34] = 90;
+    levels[1] = led_frame_blend_level(200, 90);
+
+    led_strip_out_show_blend(&a, 200, &b, 90);
+    check_transfer(levels);
+}
+
+ZTEST(led_strip_out, test_levels)
+{
+    uint8_t levels[STRIP_MOCK_LEN] = { 0 };
+    const size_t count = STRIP_MOCK_LEN - 5;
+
+    /* Pixels past count stay off */
+    for (size_t i = 0; i < count; i++) {
+        levels[i] = (uint8_t)(i * 7 + 10);
+    }
+
+    led_strip_out_show_levels(levels, count);
+    check_transfer(levels);
+}
+
+ZTEST(led_strip_out, test_latest_frame_wins)
+{
+    struct led_frame frame = { 0 };
+    uint8_t levels[STRIP_MOCK_LEN] = { 0 };
+    struct led_strip_out_stats before;
+    struct led_strip_out_stats after;
+    const struct led_rgb *px;
+    size_t len;
+
+    led_strip_out_get_stats(&before);
+
+    /* Three frames back to back: each is sent or replaced, none torn */
+    for (size_t led = 0; led < 3; led++) {
+        led_frame_clear(&frame);
+        set_led(&frame, led);
+        led_strip_out_show(&frame, LED_LEVEL_FULL);
+    }
+    k_sleep(K_MSEC(10));
+
+    led_strip_out_get_stats(&after);
+    zassert_equal((after.transfers - before.transfers) +
+                  (after.coalesced - before.coalesced), 3,
+                  "frames lost: %u sent, %u replaced",
+                  after.transfers - before.transfers,
+                  after.coalesced - before.coalesced);
+    zassert_equal(strip_mock_transfers(), after.transfers - before.transfers);
+
+    levels[2] = LED_LEVEL_FULL;
+    px = strip_mock_last(&len);
+    zassert_equal(len, STRIP_MOCK_LEN);
+    for (size_t i = 0; i < STRIP_MOCK_LEN; i++) {
+        check_pixel(px, i, levels[i]);
+    }
+}
+
+ZTEST_SUITE(led_strip_out, NULL, strip_setup, strip_before, NULL, NULL);
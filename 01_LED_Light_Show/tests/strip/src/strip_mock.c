@@ -0,0 +1,98 @@
+/*
+ * Mock LED Strip
+ *
+ * Description: Records the pixel buffers handed to led_strip_update_rgb()
+ *              instead of clocking them out, see strip_mock.h.
+ *
+ * License:     MIT
+ */
+
+#define DT_DRV_COMPAT vnd_led_strip_mock
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/led_strip.h>
+
+#include "strip_mock.h"
+
+BUILD_ASSERT(DT_INST_PROP(0, chain_length) == STRIP_MOCK_LEN,
+             "STRIP_MOCK_LEN does not match strip.overlay");
+
+static struct led_rgb last[STRIP_MOCK_LEN];
+static size_t last_len;
+static uint32_t transfers;
+
+static K_SEM_DEFINE(xfer_sem, 0, K_SEM_MAX_LIMIT);
+
+static int mock_update_rgb(const struct device *dev, struct led_rgb *pixels,
+                           size_t num_pixels)
+{
+    ARG_UNUSED(dev);
+
+    if (num_pixels > STRIP_MOCK_LEN) {
+        return -EINVAL;
+    }
+
+    memcpy(last, pixels, num_pixels * sizeof(pixels[0]));
+    last_len = num_pixels;
+    transfers++;
+
+    /* A real driver may clobber the buffer (SPI encoding in place) */
+    memset(pixels, 0xA5, num_pixels * sizeof(pixels[0]));
+
+    k_sem_give(&xfer_sem);
+
+    return 0;
+}
+
+static int mock_update_channels(const struct device *dev, uint8_t *channels,
+                                size_t num_channels)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(channels);
+    ARG_UNUSED(num_channels);
+
+    return -ENOTSUP;
+}
+
+static size_t mock_length(const struct device *dev)
+{
+    ARG_UNUSED(dev);
+
+    return STRIP_MOCK_LEN;
+}
+
+static const struct led_strip_driver_api mock_api = {
+    .update_rgb = mock_update_rgb,
+    .update_channels = mock_update_channels,
+    .length = mock_length,
+};
+
+int strip_mock_wait(k_timeout_t timeout)
+{
+    return k_sem_take(&xfer_sem, timeout);
+}
+
+void strip_mock_reset(void)
+{
+    k_sem_reset(&xfer_sem);
+    transfers = 0;
+    last_len = 0;
+}
+
+uint32_t strip_mock_transfers(void)
+{
+    return transfers;
+}
+
+const struct led_rgb *strip_mock_last(size_t *num_pixels)
+{
+    *num_pixels = last_len;
+
+    return last;
+}
+
+DEVICE_DT_INST_DEFINE(0, NULL, NULL, NULL, NULL, POST_KERNEL,
+                      CONFIG_LED_STRIP_INIT_PRIORITY, &mock_api);
@@ -0,0 +1,48 @@
+/*
+ * Mock LED Strip
+ *
+ * Description: led_strip driver for the "vnd,led-strip-mock" devicetree
+ *              node. It sends nothing anywhere: every buffer passed to
+ *              led_strip_update_rgb() is copied and counted, so a test
+ *              can check the pixels the show transferred.
+ *
+ * License:     MIT
+ */
+
+#ifndef STRIP_MOCK_H_
+#define STRIP_MOCK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/drivers/led_strip.h>
+
+/** Pixels of the mock strip (chain-length in strip.overlay) */
+#define STRIP_MOCK_LEN 40
+
+/**
+ * @brief Wait for the next transfer
+ *
+ * @param timeout How long to wait
+ *
+ * @return 0 once a transfer was recorded, -EAGAIN on timeout
+ */
+int strip_mock_wait(k_timeout_t timeout);
+
+/**
+ * @brief Forget the recorded transfers
+ */
+void strip_mock_reset(void);
+
+/**
+ * @brief Number of transfers since the last reset
+ */
+uint32_t strip_mock_transfers(void);
+
+/**
+ * @brief Pixels of the last transfer
+ *
+ * @param num_pixels Set to the pixel count of that transfer
+ */
+const struct led_rgb *strip_mock_last(size_t *num_pixels);
+
+#endif /* STRIP_MOCK_H_ */
@@ -0,0 +1,323 @@
+/*
+ * Golden LED Trace Test
+ *
+ * Description: Plays a fixed playlist on the emulated GPIO controller of
+ *              native_sim and records what the pins do, not what the show
+ *              asked for: the LED pins are configured as inputs and
+ *              outputs, so gpio_emul loops every output change back into
+ *              an input edge, and the edge callback stamps the new pin
+ *              state with the simulated time. The trace is compared with
+ *              the golden CSVs in golden/: same changes in the same order,
+ *              each within TRACE_TOLERANCE_TICKS of its golden time.
+ *
+ *              On a mismatch the recorded trace is printed in the golden
+ *              format ("GOLDEN," lines) for review. With
+ *              CONFIG_TRACE_TEST_RECORD it is always printed and not
+ *              compared, which is how the golden CSVs are generated.
+ *
+ * License:     MIT
+ */
+
+#include <stdlib.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/ztest.h>
+
+#include "effects.h"
+#include "led_frame.h"
+#include "led_output.h"
+#include "led_show.h"
+#include "led_tempo.h"
+
+#define LED_SPEC(node_id) GPIO_DT_SPEC_GET(node_id, gpios),
+
+static const struct gpio_dt_spec leds[] = {
+    DT_FOREACH_CHILD_STATUS_OKAY(DT_CHOSEN(led_show_leds), LED_SPEC)
+};
+
+#define NUM_LEDS ARRAY_SIZE(leds)
+
+/*
+ * Allowed difference between a recorded and a golden time. Deadlines
+ * are whole kernel ticks; golden times are exact, so a change can be up
+ * to one tick away from them.
+ */
+#define TRACE_TOLERANCE_TICKS 1
+
+/* Most changes recorded per run */
+#define TRACE_MAX_EVENTS 64
+
+/* ============================================================================
+ * GOLDEN TRACES
+ * ============================================================================
+ * golden/<name>.csv, embedded by CMake (generate_inc_file_for_target).
+ */
+
+static const char golden_150bpm[] = {
+#include "show_150bpm.csv.inc"
+    '\0'
+};
+
+static const char golden_128bpm[] = {
+#include "show_128bpm.csv.inc"
+    '\0'
+};
+
+/* The playlist of the golden traces */
+static const struct led_playlist_entry entries[] = {
+    { .effect = LED_EFFECT_KNIGHT_RIDER, .cycles = 1,
+      .tempo_pct = LED_SHOW_SPEED_NOMINAL, .gap_ms = 100 },
+    { .effect = LED_EFFECT_ALTERNATE_FLASH, .cycles = 2,
+      .tempo_pct = LED_SHOW_SPEED_NOMINAL, .gap_ms = 200 },
+    { .effect = LED_EFFECT_BINARY_COUNTER, .cycles = 1,
+      .tempo_pct = LED_SHOW_SPEED_NOMINAL, .gap_ms = 400 },
+};
+
+static const struct led_playlist playlist = {
+    .entries = entries,
+    .num_entries = ARRAY_SIZE(entries),
+};
+
+/* One loop (3800 ms) and half of the first frame of the next one */
+#define TRACE_WINDOW_MS 3850
+
+/* ============================================================================
+ * RECORDING
+ * ============================================================================
+ */
+
+struct trace_event {
+    k_ticks_t ticks;        /* Simulated time of the change */
+    uint32_t leds;          /* LED pins on after it, bit N = LED N */
+};
+
+static struct trace_event events[TRACE_MAX_EVENTS];
+static size_t num_events;
+static bool overflow;
+static struct gpio_callback led_cbs[NUM_LEDS];
+
+static struct led_show show;
+static int init_ret;
+
+/**
+ * @brief Output state of the LED pins, bit N = LED N
+ */
+static uint32_t led_pins(void)
+{
+    uint32_t pins = 0;
+
+    for (size_t i = 0; i < NUM_LEDS; i++) {
+        if (gpio_emul_output_get(leds[i].port, leds[i].pin) > 0) {
+            pins |= BIT(i);
+        }
+    }
+
+    return pins;
+}
+
+/**
+ * @brief Edge of an LED pin, looped back from its output
+ *
+ * One port write can raise an edge on several pins; only the first one
+ * that sees a new pin state records it.
+ */
+static void trace_edge(const struct device *port, struct gpio_callback *cb,
+                       gpio_port_pins_t pins)
+{
+    uint32_t state = led_pins();
+    uint32_t last = (num_events > 0) ? events[num_events - 1].leds : 0;
+
+    ARG_UNUSED(port);
+    ARG_UNUSED(cb);
+    ARG_UNUSED(pins);
+
+    if (state == last) {
+        return;
+    }
+    if (num_events == TRACE_MAX_EVENTS) {
+        overflow = true;
+        return;
+    }
+
+    events[num_events].ticks = k_uptime_ticks();
+    events[num_events].leds = state;
+    num_events++;
+}
+
+/* ============================================================================
+ * COMPARISON
+ * ============================================================================
+ */
+
+/**
+ * @brief Read the next "t_us,leds" line of a golden CSV
+ *
+ * Comment lines ("#") and the header line are skipped.
+ *
+ * @return false at the end of the CSV
+ */
+static bool golden_next(const char **pos, uint32_t *t_us, uint32_t *leds)
+{
+    const char *p = *pos;
+
+    while (*p != '\0') {
+        const char *line = p;
+
+        while (*p != '\0' && *p != '\n') {
+            p++;
+        }
+        if (*p == '\n') {
+            p++;
+        }
+
+        if (*line >= '0' && *line <= '9') {
+            char *end;
+
+            *t_us = strtoul(line, &end, 10);
+            *leds = strtoul(end + 1, NULL, 16);
+            *pos = p;
+            return true;
+        }
+    }
+
+    *pos = p;
+    return false;
+}
+
+/**
+ * @brief Time of a recorded change, in us since the first change
+ */
+static uint32_t event_us(size_t i)
+{
+    return (uint32_t)k_ticks_to_us_floor64(events[i].ticks -
+                                           events[0].ticks);
+}
+
+static void print_trace(const char *name, size_t count)
+{
+    TC_PRINT("Recorded trace for %s:\n", name);
+    for (size_t i = 0; i < count; i++) {
+        TC_PRINT("GOLDEN,%s,%u,0x%x\n", name, event_us(i), events[i].leds);
+    }
+}
+
+/**
+ * @brief Play the playlist at @p bpm and compare the trace with @p golden
+ */
+static void check_golden(const char *name, const char *golden, uint32_t bpm)
+{
+    uint32_t window_us = (uint32_t)((uint64_t)TRACE_WINDOW_MS * 1000U *
+                                    LED_TEMPO_BPM(LED_TEMPO_REF_BPM) / bpm);
+    uint32_t tol_us = k_ticks_to_us_ceil32(TRACE_TOLERANCE_TICKS);
+    const char *pos = golden;
+    uint32_t t_us;
+    uint32_t leds;
+    size_t recorded;
+    size_t n = 0;
+    bool match = true;
+
+    zassert_ok(led_tempo_set_bpm(bpm));
+    num_events = 0;
+    overflow = false;
+
+    led_show_start(&show);
+    k_sleep(K_USEC(window_us + tol_us));
+    recorded = num_events;
+    zassert_ok(led_show_stop(&show, K_MSEC(100)));
+
+    zassert_false(overflow, "more than %d changes", TRACE_MAX_EVENTS);
+    zassert_true(recorded > 0, "no LED changes recorded");
+
+    /* A change just past the window is not part of it */
+    while (recorded > 0 && event_us(recorded - 1) >= window_us) {
+        recorded--;
+    }
+
+    if (IS_ENABLED(CONFIG_TRACE_TEST_RECORD)) {
+        print_trace(name, recorded);
+        ztest_test_skip();
+    }
+
+    while (golden_next(&pos, &t_us, &leds)) {
+        if (n >= recorded || events[n].leds != leds ||
+            abs((int32_t)(event_us(n) - t_us)) > (int32_t)tol_us) {
+            TC_PRINT("%s: change %u: expected %u us 0x%x\n", name,
+                     (unsigned int)n, t_us, leds);
+            match = false;
+            break;
+        }
+        n++;
+    }
+
+    if (match && n != recorded) {
+        TC_PRINT("%s: %u changes, golden has %u\n", name,
+                 (unsigned int)recorded, (unsigned int)n);
+        match = false;
+    }
+
+    if (!match) {
+        print_trace(name, recorded);
+    }
+    zassert_true(match, "%s: trace differs from golden/%s.csv (%u us)",
+                 name, name, tol_us);
+}
+
+/* ============================================================================
+ * TESTS
+ * ============================================================================
+ */
+
+static void *trace_setup(void)
+{
+    for (size_t i = 0; i < NUM_LEDS; i++) {
+        const struct gpio_dt_spec *led = &leds[i];
+
+        /* Input too, so gpio_emul reports output changes as edges */
+        init_ret = gpio_pin_configure_dt(led,
+                                         GPIO_INPUT | GPIO_OUTPUT_INACTIVE);
+        if (init_ret == 0) {
+            init_ret = gpio_pin_interrupt_configure_dt(led,
+                                                       GPIO_INT_EDGE_BOTH);
+        }
+        if (init_ret == 0) {
+            gpio_init_callback(&led_cbs[i], trace_edge, BIT(led->pin));
+            init_ret = gpio_add_callback_dt(led, &led_cbs[i]);
+        }
+        if (init_ret < 0) {
+            return NULL;
+        }
+    }
+
+    init_ret = led_frame_init(leds, NUM_LEDS);
+    if (init_ret < 0) {
+        return NULL;
+    }
+    led_output_init();
+    led_show_init(&show, &playlist);
+
+    return NULL;
+}
+
+static void trace_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    /* Let the all-off frame of the previous run go out */
+    k_sleep(K_MSEC(10));
+
+    zassert_ok(init_ret, "LED pins not set up");
+    zassert_false(led_output_has_dimming(), "LEDs must be on GPIO");
+    zassert_equal(led_pins(), 0, "LEDs not off");
+}
+
+ZTEST(trace, test_golden_150bpm)
+{
+    check_golden("show_150bpm", golden_150bpm, LED_TEMPO_BPM(150));
+}
+
+ZTEST(trace, test_golden_128bpm)
+{
+    check_golden("show_128bpm", golden_128bpm, LED_TEMPO_BPM(128));
+}
+
+ZTEST_SUITE(trace, NULL, trace_setup, trace_before, NULL, NULL);